@@ -1,16 +1,34 @@
 #version 330 core
 
 in vec2 position;
-in vec2 uv;
 
 out vec2 uvs;
 
-uniform mat4 mvp;
+uniform mat4 viewprojection;
+uniform mat4 hex2cart;
+uniform vec3 tile_offset;
+uniform float tile_scale;
+uniform vec4 uvrect;
+
+// visible hex range: columns starting at hex_xmin, each column covering
+// hex_rows tiles starting at screen row (2y + x) hex_rowmin
+uniform int hex_xmin;
+uniform int hex_rowmin;
+uniform int hex_rows;
 
 void main() {
+    // generate the hex position from the instance number
+    int x = hex_xmin + gl_InstanceID / hex_rows;
+    int y = int(floor(float(hex_rowmin - x) / 2.0)) + gl_InstanceID % hex_rows;
+    vec3 hexpos = vec3(x, y, -(x + y));
+
+    // place the sprite at the center of its hex tile
+    vec3 center = (hex2cart * vec4(hexpos, 1.0)).xyz + tile_offset;
+
     // output position of the vertex
-    gl_Position = mvp * vec4(position, 0.0, 1.0);
+    gl_Position = viewprojection * vec4(center + vec3(position * tile_scale, 0.0), 1.0);
 
-    // output uv position
-    uvs = uv;
+    // output uv position by picking the corners of the atlas rectangle
+    uvs = vec2(mix(uvrect.x, uvrect.z, position.x + 0.5),
+               mix(uvrect.w, uvrect.y, position.y + 0.5));
 }
@@ -0,0 +1,36 @@
+#version 330 core
+
+in vec2 uvs;
+in vec2 worldxy;
+
+uniform sampler2D tex;
+uniform sampler2D depthtex;
+uniform vec2 rows;              // screen rows spread over the depth of the impostor
+uniform vec2 depth_range;       // screen rows mapped onto the near and far plane
+uniform vec2 alpha_range;       // alpha values drawn in this pass
+uniform vec4 selection_rect;    // selected area in world space (xmin, ymin, xmax, ymax)
+uniform vec3 selection_color;
+
+out vec4 fragColor;
+
+void main() {
+    // the impostor holds colors premultiplied by alpha; as for the tiles, the
+    // opaque texels and the antialiased edges are drawn in separate passes
+    vec4 color = texture(tex, uvs);
+    if(color.a <= alpha_range.x || color.a > alpha_range.y) {
+        discard;
+    }
+
+    fragColor = vec4(color.rgb / color.a, color.a);
+
+    // the depth of the tile in the impostor is converted to the screen row
+    // of the tile, which is placed in the depth range of the frame
+    float row = mix(rows.x, rows.y, texture(depthtex, uvs).r);
+    float z = clamp(2.0 * (row - depth_range.x) / (depth_range.y - depth_range.x) - 1.0, -0.999, 0.999);
+    gl_FragDepth = 0.5 * z + 0.5;
+
+    // the selection is not part of the cached impostor, hence it is tinted here
+    if(all(greaterThanEqual(worldxy, selection_rect.xy)) && all(lessThanEqual(worldxy, selection_rect.zw))) {
+        fragColor.rgb = mix(fragColor.rgb, selection_color, 0.5);
+    }
+}
@@ -0,0 +1,23 @@
+#version 330 core
+
+in vec2 position;
+
+out vec2 uvs;
+out vec2 worldxy;
+
+uniform mat4 viewprojection;
+uniform mat4 impostor_viewprojection;
+uniform vec4 rect;
+
+void main() {
+    // span the rectangle of the chunk in world space
+    vec4 worldpos = vec4(mix(rect.xy, rect.zw, position + 0.5), 0.0, 1.0);
+
+    // output position of the vertex
+    gl_Position = viewprojection * worldpos;
+    worldxy = worldpos.xy;
+
+    // the impostor was rendered with its own projection, which maps the
+    // rectangle onto the complete texture
+    uvs = (impostor_viewprojection * worldpos).xy * 0.5 + 0.5;
+}
@@ -1,12 +1,20 @@
 #version 330 core
 
 in vec2 uvs;
+in vec3 color;
 
 uniform sampler2D tex;
-uniform vec3 color;
+uniform vec2 alpha_range;   // only texels with an alpha in (x, y] are drawn
 
 out vec4 fragColor;
 
 void main() {
+    // opaque texels and antialiased edges are drawn in separate passes, such
+    // that the edges are blended instead of occluding the tiles behind them
+    float alpha = texture(tex, uvs).a;
+    if(alpha <= alpha_range.x || alpha > alpha_range.y) {
+        discard;
+    }
+
     fragColor = 0.25 * texture(tex, uvs) + 0.75 * texture(tex, uvs) * vec4(color, 1.0);
 }
@@ -1,16 +1,54 @@
 #version 330 core
 
+// per-vertex attributes
 in vec2 position;
-in vec2 uv;
+
+// per-instance attributes
+in vec2 hexpos;
+in vec4 uvrect;
+in vec4 tilecolor;
 
 out vec2 uvs;
+out vec3 color;
 
-uniform mat4 mvp;
+uniform mat4 viewprojection;
+uniform mat4 hex2cart;
+uniform vec3 tile_offset;
+uniform float tile_scale;
+uniform vec2 highlight;
+uniform vec2 highlight_factor;
+uniform vec2 depth_range;   // screen rows mapped onto the near and far plane
+uniform vec4 selection;     // selected columns (x, y) and screen rows (z, w)
+uniform vec3 selection_color;
 
 void main() {
+    // place the sprite at the center of its hex tile
+    vec3 center = (hex2cart * vec4(hexpos, -(hexpos.x + hexpos.y), 1.0)).xyz + tile_offset;
+
     // output position of the vertex
-    gl_Position = mvp * vec4(position, 0.0, 1.0);
+    gl_Position = viewprojection * vec4(center + vec3(position * tile_scale, 0.0), 1.0);
+
+    // tiles further up the screen are placed behind the tiles below them such
+    // that the draw order of the instances does not matter; only the rows
+    // that can be on screen are spread over the depth range
+    float row = 2.0 * hexpos.y + hexpos.x;
+    gl_Position.z = clamp(2.0 * (row - depth_range.x) / (depth_range.y - depth_range.x) - 1.0, -0.999, 0.999);
+
+    // removed tiles are moved outside of the clipping volume
+    if(tilecolor.a == 0.0) {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+    }
+
+    // output uv position by picking the corners of the atlas rectangle
+    uvs = vec2(mix(uvrect.x, uvrect.z, position.x + 0.5),
+               mix(uvrect.w, uvrect.y, position.y + 0.5));
 
-    // output uv position
-    uvs = uv;
+    // tint the selected tiles and brighten the tile under the cursor
+    color = tilecolor.rgb;
+    if(hexpos.x >= selection.x && hexpos.x <= selection.y && row >= selection.z && row <= selection.w) {
+        color = mix(color, selection_color, 0.5);
+    }
+    if(hexpos == highlight) {
+        color = highlight_factor.x * color + highlight_factor.y;
+    }
 }
@@ -7,16 +7,27 @@
  #
 ####################################################################################################
 
-HEADERS       = src/data/map.h \
+HEADERS       = src/cli/batch_processor.h \
+                src/data/chunk_index.h \
+                src/data/inventory.h \
+                src/data/json_reader.h \
+                src/data/map.h \
+                src/data/map_fragment.h \
                 src/data/map_io.h \
+                src/data/map_journal.h \
+                src/data/map_region.h \
+                src/data/png_writer.h \
+                src/data/stamp_library.h \
                 src/data/tile.h \
                 src/data/tile_manager.h \
                 src/gui/anaglyph_widget.h \
+                src/gui/bom_panel.h \
                 src/gui/interface_window.h \
                 src/gui/mainwindow.h \
                 src/gui/shader_program_types.h \
                 src/gui/shader_program.h \
                 src/gui/shader_program_manager.h \
+                src/gui/map_exporter.h \
                 src/gui/map_renderer.h \
                 src/gui/scene.h \
                 src/gui/tile_selector.h \
@@ -24,24 +35,39 @@ HEADERS       = src/data/map.h \
                 src/config.h
 
 SOURCES       = src/main.cpp \
+                src/cli/batch_processor.cpp \
+                src/data/chunk_index.cpp \
+                src/data/inventory.cpp \
+                src/data/json_reader.cpp \
                 src/data/map.cpp \
+                src/data/map_fragment.cpp \
                 src/data/map_io.cpp \
+                src/data/map_journal.cpp \
+                src/data/map_region.cpp \
+                src/data/png_writer.cpp \
+                src/data/stamp_library.cpp \
                 src/data/tile.cpp \
                 src/data/tile_manager.cpp \
                 src/gui/anaglyph_widget.cpp \
+                src/gui/bom_panel.cpp \
                 src/gui/interface_window.cpp \
                 src/gui/mainwindow.cpp \
                 src/gui/shader_program.cpp \
                 src/gui/shader_program_manager.cpp \
+                src/gui/map_exporter.cpp \
                 src/gui/map_renderer.cpp \
                 src/gui/scene.cpp \
                 src/gui/tile_selector.cpp \
                 src/gui/user_action.cpp
 
-QT           += core gui widgets
+QT           += core gui widgets concurrent
 CONFIG       += force_debug_info
 CONFIG       += c++17
 
+# compile the tile catalogue into the executable such that it does not need to
+# be parsed at startup; remove this line to read tiledata.json at runtime
+CONFIG       += generated_tile_catalogue
+
 linux {
     QMAKE_CXXFLAGS+= -fopenmp
     QMAKE_LFLAGS +=  -fopenmp
@@ -51,8 +77,25 @@ linux {
 win32 {
     INCLUDEPATH += ../../Libraries/boost-1.70.0-win-x64/include
     INCLUDEPATH += ../../Libraries/glm-0.9.8.4-win-x64
-    Release:LIBS += "-L../../../Libraries/boost-1.70.0-win-x64/lib" -lboost_regex-vc141-mt-x64-1_70 -lboost_bzip2-vc141-mt-x64-1_70
-    Debug:LIBS += "-L../../../Libraries/boost-1.70.0-win-x64/lib" -lboost_regex-vc141-mt-gd-x64-1_70 -lboost_bzip2-vc141-mt-gd-x64-1_70
+    Release:LIBS += "-L../../../Libraries/boost-1.70.0-win-x64/lib" -lboost_regex-vc141-mt-x64-1_70 -lboost_bzip2-vc141-mt-x64-1_70 -lboost_iostreams-vc141-mt-x64-1_70 -lboost_zlib-vc141-mt-x64-1_70
+    Debug:LIBS += "-L../../../Libraries/boost-1.70.0-win-x64/lib" -lboost_regex-vc141-mt-gd-x64-1_70 -lboost_bzip2-vc141-mt-gd-x64-1_70 -lboost_iostreams-vc141-mt-gd-x64-1_70 -lboost_zlib-vc141-mt-gd-x64-1_70
+}
+
+generated_tile_catalogue {
+    win32 {
+        PYTHON = python
+    } else {
+        PYTHON = python3
+    }
+    TILE_CATALOGUE = assets/configuration/tiledata.json
+    tile_catalogue.input = TILE_CATALOGUE
+    tile_catalogue.output = $$OUT_PWD/tile_catalogue.h
+    tile_catalogue.commands = $$PYTHON $$PWD/scripts/generate_tile_catalogue.py ${QMAKE_FILE_IN} ${QMAKE_FILE_OUT}
+    tile_catalogue.depends = $$PWD/scripts/generate_tile_catalogue.py
+    tile_catalogue.CONFIG += no_link target_predeps
+    QMAKE_EXTRA_COMPILERS += tile_catalogue
+    INCLUDEPATH += $$OUT_PWD
+    DEFINES += USE_GENERATED_TILE_CATALOGUE
 }
 
 RESOURCES += \
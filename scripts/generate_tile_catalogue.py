@@ -0,0 +1,42 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+#
+# Generate a C++ header holding the tile catalogue from tiledata.json such
+# that the catalogue does not have to be parsed at startup. This script is
+# invoked by qmake, see hextontiler.pro.
+#
+# usage: generate_tile_catalogue.py <tiledata.json> <tile_catalogue.h>
+#
+
+import json
+import sys
+
+def main():
+    if len(sys.argv) != 3:
+        print('usage: %s <tiledata.json> <tile_catalogue.h>' % sys.argv[0])
+        sys.exit(1)
+
+    # tiles keep the order of the json file, which determines the tile ids
+    with open(sys.argv[1]) as f:
+        tiles = json.load(f)
+
+    names = []
+    uvs = []
+    for name, data in tiles.items():
+        names.append('    "%s"' % name)
+        uvs.append('    {%sf, %sf, %sf, %sf}' % tuple(repr(float(data[k])) for k in ('uvx1', 'uvy1', 'uvx2', 'uvy2')))
+
+    with open(sys.argv[2], 'w') as f:
+        f.write('// generated from %s by generate_tile_catalogue.py, do not edit\n\n' % sys.argv[1].replace('\\', '/').split('/')[-1])
+        f.write('#pragma once\n\n')
+        f.write('#include <cstddef>\n\n')
+        f.write('namespace tile_catalogue {\n\n')
+        f.write('constexpr size_t size = %i;\n\n' % len(names))
+        f.write('constexpr const char* names[size] = {\n%s\n};\n\n' % ',\n'.join(names))
+        f.write('// uvx1, uvy1, uvx2, uvy2\n')
+        f.write('constexpr float uvs[size][4] = {\n%s\n};\n\n' % ',\n'.join(uvs))
+        f.write('} // namespace tile_catalogue\n')
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,317 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "batch_processor.h"
+
+// the exporter is only used by the export command, keep it out of the header
+#include "../gui/map_exporter.h"
+
+/**
+ * @brief      Constructs a new instance.
+ */
+BatchProcessor::BatchProcessor() :
+    tile_manager(std::make_shared<TileManager>(QString::fromLocal8Bit(qgetenv("HEXTONTILER_TILE_CATALOGUE")))) {
+
+}
+
+/**
+ * @brief      Whether the command line requests a batch command
+ *
+ * @param[in]  argc  The number of arguments
+ * @param      argv  The arguments
+ *
+ * @return     True if a batch command is given, False otherwise.
+ */
+bool BatchProcessor::is_batch_command(int argc, char* argv[]) {
+    if(argc < 2) {
+        return false;
+    }
+
+    const std::string command = argv[1];
+    return command == "validate" || command == "bom" || command == "buildable" || command == "convert" ||
+           command == "export" || command == "--help" || command == "-h";
+}
+
+/**
+ * @brief      Whether the batch command renders maps, which requires a
+ *             QGuiApplication instead of a QCoreApplication
+ *
+ * @param[in]  argc  The number of arguments
+ * @param      argv  The arguments
+ *
+ * @return     True if rendering is required, False otherwise.
+ */
+bool BatchProcessor::requires_rendering(int argc, char* argv[]) {
+    return argc >= 2 && std::string(argv[1]) == "export";
+}
+
+/**
+ * @brief      Run the batch command
+ *
+ * @param[in]  arguments  The command line arguments
+ *
+ * @return     exit code; 0 if all maps were processed successfully
+ */
+int BatchProcessor::run(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Process hexton tile maps without a display.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "validate, bom, buildable, convert or export");
+    parser.addPositionalArgument("paths", "Map files or directories holding map files", "<paths...>");
+
+    QCommandLineOption option_to(QStringList() << "t" << "to", "Format of converted maps (htm or htb).", "format");
+    QCommandLineOption option_output(QStringList() << "o" << "output", "Directory for converted maps and images.", "dir");
+    QCommandLineOption option_jobs(QStringList() << "j" << "jobs", "Number of maps processed in parallel.", "n");
+    QCommandLineOption option_tile_size(QStringList() << "s" << "tile-size", "Width of a tile in exported images in pixels.", "n");
+    QCommandLineOption option_no_colors(QStringList() << "no-colors", "Export the tiles without their category colors.");
+    QCommandLineOption option_inventory(QStringList() << "i" << "inventory", "Inventory of owned tiles against which maps are checked.", "file");
+    parser.addOption(option_to);
+    parser.addOption(option_output);
+    parser.addOption(option_jobs);
+    parser.addOption(option_tile_size);
+    parser.addOption(option_no_colors);
+    parser.addOption(option_inventory);
+    parser.process(arguments);
+
+    QStringList positional = parser.positionalArguments();
+    if(positional.size() < 2) {
+        parser.showHelp(1);
+    }
+
+    this->command = positional.takeFirst();
+    if(this->command != "validate" && this->command != "bom" && this->command != "buildable" &&
+       this->command != "convert" && this->command != "export") {
+        std::cerr << "[ERROR] Unknown command: " << this->command.toStdString() << std::endl;
+        return 1;
+    }
+    if(this->command == "convert" || this->command == "export") {
+        if(this->command == "convert") {
+            this->target_suffix = parser.value(option_to).toLower();
+            if(this->target_suffix != "htm" && this->target_suffix != "htb") {
+                std::cerr << "[ERROR] convert requires --to htm or --to htb" << std::endl;
+                return 1;
+            }
+        } else {
+            this->target_suffix = "png";
+            if(parser.isSet(option_tile_size)) {
+                this->tile_size = std::max(1, parser.value(option_tile_size).toInt());
+            }
+            this->tile_colors = !parser.isSet(option_no_colors);
+        }
+        this->output_dir = parser.value(option_output);
+        if(!this->output_dir.isEmpty() && !QDir().mkpath(this->output_dir)) {
+            std::cerr << "[ERROR] Could not create directory: " << this->output_dir.toStdString() << std::endl;
+            return 1;
+        }
+    }
+
+    if(this->command == "buildable") {
+        if(!parser.isSet(option_inventory)) {
+            std::cerr << "[ERROR] buildable requires --inventory" << std::endl;
+            return 1;
+        }
+        try {
+            auto inventory = std::make_shared<Inventory>(this->tile_manager);
+            inventory->load(parser.value(option_inventory));
+            this->inventory = inventory;
+        } catch(const std::exception& e) {
+            std::cerr << "[ERROR] " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+#ifdef _OPENMP
+    if(parser.isSet(option_jobs)) {
+        omp_set_num_threads(std::max(1, parser.value(option_jobs).toInt()));
+    }
+#endif
+
+    const QStringList filenames = this->collect_maps(positional);
+    if(filenames.isEmpty()) {
+        std::cerr << "[ERROR] No map files found" << std::endl;
+        return 1;
+    }
+
+    // maps sharing a base name would be written to the same file, possibly
+    // from different threads
+    if((this->command == "convert" || this->command == "export") && !this->check_targets(filenames)) {
+        return 1;
+    }
+
+    // the maps are distributed over the cores; large files are then parsed
+    // on a single core as nested parallelism is disabled
+    std::vector<Result> results(filenames.size());
+    if(this->command == "export") {
+        for(int i=0; i<filenames.size(); i++) {
+            results[i] = this->process(filenames[i]);
+        }
+    } else {
+        #pragma omp parallel for schedule(dynamic)
+        for(int i=0; i<filenames.size(); i++) {
+            results[i] = this->process(filenames[i]);
+        }
+    }
+
+    // report in the order of the input
+    unsigned int nr_failed = 0;
+    unsigned int nr_buildable = 0;
+    for(const Result& result : results) {
+        std::cout << result.output;
+        nr_failed += result.success ? 0 : 1;
+        nr_buildable += result.buildable ? 1 : 0;
+    }
+    std::cerr << "Processed " << filenames.size() << " maps, " << nr_failed << " failed." << std::endl;
+    if(this->command == "buildable") {
+        std::cerr << nr_buildable << " of " << filenames.size() << " maps can be built from the inventory." << std::endl;
+    }
+
+    return nr_failed > 0 ? 1 : 0;
+}
+
+/**
+ * @brief      Collect the map files in a list of files and directories
+ *
+ * @param[in]  paths  The paths
+ *
+ * @return     The map files
+ */
+QStringList BatchProcessor::collect_maps(const QStringList& paths) const {
+    QStringList filenames;
+
+    for(const QString& path : paths) {
+        if(!QFileInfo(path).isDir()) {
+            filenames.append(path);
+            continue;
+        }
+
+        QStringList found;
+        QDirIterator it(path, QStringList() << "*.htm" << "*.htb", QDir::Files, QDirIterator::Subdirectories);
+        while(it.hasNext()) {
+            found.append(it.next());
+        }
+        found.sort();
+        filenames.append(found);
+    }
+
+    return filenames;
+}
+
+/**
+ * @brief      Get the file to which a converted or exported map is written
+ *
+ * @param[in]  filename  The filename of the map
+ *
+ * @return     The target filename
+ */
+QString BatchProcessor::get_target(const QString& filename) const {
+    const QFileInfo info(filename);
+    const QString dir = this->output_dir.isEmpty() ? info.path() : this->output_dir;
+    return dir + "/" + info.completeBaseName() + "." + this->target_suffix;
+}
+
+/**
+ * @brief      Verify that no two maps are written to the same file and
+ *             that no map overwrites itself; conflicts are reported
+ *
+ * @param[in]  filenames  The filenames of the maps
+ *
+ * @return     True if all targets are distinct, False otherwise.
+ */
+bool BatchProcessor::check_targets(const QStringList& filenames) const {
+    QHash<QString, QString> sources;    // target -> map written to it
+    bool valid = true;
+
+    for(const QString& filename : filenames) {
+        const QString source = QDir::cleanPath(QFileInfo(filename).absoluteFilePath());
+        const QString target = QDir::cleanPath(QFileInfo(this->get_target(filename)).absoluteFilePath());
+
+        if(target == source) {
+            std::cerr << "[ERROR] " << filename.toStdString() << " would be overwritten by its own conversion" << std::endl;
+            valid = false;
+            continue;
+        }
+
+        auto got = sources.constFind(target);
+        if(got != sources.constEnd()) {
+            std::cerr << "[ERROR] " << got.value().toStdString() << " and " << filename.toStdString()
+                      << " would both be written to " << target.toStdString() << std::endl;
+            valid = false;
+            continue;
+        }
+        sources.insert(target, filename);
+    }
+
+    return valid;
+}
+
+/**
+ * @brief      Process a single map
+ *
+ * @param[in]  filename  The filename
+ *
+ * @return     The result
+ */
+BatchProcessor::Result BatchProcessor::process(const QString& filename) const {
+    Result result;
+    MapIO map_io(this->tile_manager);
+
+    try {
+        auto map = map_io.load(filename);
+
+        if(this->command == "validate") {
+            result.output = "OK    " + filename.toStdString() + " (" + std::to_string(map->size()) + " tiles)\n";
+        } else if(this->command == "bom") {
+            result.output = "# " + filename.toStdString() + "\n" + map_io.build_bom(map).toStdString() + "\n";
+        } else if(this->command == "buildable") {
+            // the map keeps its tile counts, hence only the catalogue is visited
+            const std::vector<size_t> counts = this->tile_manager->count_bases(map->get_tile_counts());
+            result.buildable = this->inventory->covers(counts);
+            if(result.buildable) {
+                result.output = "YES   " + filename.toStdString() + "\n";
+            } else {
+                std::string shortages;
+                const std::vector<int64_t> balance = this->inventory->get_balance(counts);
+                for(unsigned int base_id=0; base_id<balance.size(); base_id++) {
+                    if(balance[base_id] < 0) {
+                        shortages += (shortages.empty() ? "" : ", ") + this->tile_manager->get_base_code(base_id) + " " + std::to_string(-balance[base_id]);
+                    }
+                }
+                result.output = "NO    " + filename.toStdString() + " (short: " + shortages + ")\n";
+            }
+        } else {
+            const QString target = this->get_target(filename);
+            if(this->command == "export") {
+                MapExporter exporter(this->tile_manager);
+                exporter.set_tile_size(this->tile_size);
+                exporter.set_tile_colors(this->tile_colors);
+                exporter.export_png(map, target);
+            } else {
+                map_io.save(map, target);
+            }
+            result.output = filename.toStdString() + " -> " + target.toStdString() + "\n";
+        }
+        result.success = true;
+    } catch(const std::exception& e) {
+        result.output = "FAIL  " + filename.toStdString() + ": " + e.what() + "\n";
+    }
+
+    return result;
+}
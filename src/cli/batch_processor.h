@@ -0,0 +1,152 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+#include <memory>
+#include <vector>
+#include <iostream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../data/map_io.h"
+#include "../data/tile_manager.h"
+#include "../data/inventory.h"
+
+/**
+ * @brief      Processes maps from the command line without a display
+ *
+ *             hextontiler validate <paths>
+ *             hextontiler bom <paths>
+ *             hextontiler buildable --inventory file <paths>
+ *             hextontiler convert --to htb|htm [--output dir] <paths>
+ *             hextontiler export [--tile-size n] [--no-colors] [--output dir] <paths>
+ *
+ *             Paths are map files or directories that are searched for
+ *             .htm and .htb files. The maps are processed in parallel,
+ *             except for exports which share the OpenGL context of the
+ *             main thread.
+ */
+class BatchProcessor {
+private:
+    std::shared_ptr<TileManager> tile_manager;
+
+    QString command;            // validate, bom, buildable, convert or export
+    QString target_suffix;      // suffix of converted maps
+    QString output_dir;         // directory of converted maps, empty for alongside the input
+    unsigned int tile_size = 128;   // width of a tile in exported images
+    bool tile_colors = true;        // whether exported tiles are colored
+    std::shared_ptr<const Inventory> inventory;     // tiles available to build the maps
+
+    /**
+     * @brief      Outcome of processing a single map
+     */
+    struct Result {
+        bool success = false;
+        bool buildable = false; // whether the inventory covers the map
+        std::string output;     // text printed for the map
+    };
+
+public:
+    /**
+     * @brief      Constructs a new instance.
+     */
+    BatchProcessor();
+
+    /**
+     * @brief      Whether the command line requests a batch command
+     *
+     * @param[in]  argc  The number of arguments
+     * @param      argv  The arguments
+     *
+     * @return     True if a batch command is given, False otherwise.
+     */
+    static bool is_batch_command(int argc, char* argv[]);
+
+    /**
+     * @brief      Whether the batch command renders maps, which requires a
+     *             QGuiApplication instead of a QCoreApplication
+     *
+     * @param[in]  argc  The number of arguments
+     * @param      argv  The arguments
+     *
+     * @return     True if rendering is required, False otherwise.
+     */
+    static bool requires_rendering(int argc, char* argv[]);
+
+    /**
+     * @brief      Run the batch command
+     *
+     * @param[in]  arguments  The command line arguments
+     *
+     * @return     exit code; 0 if all maps were processed successfully
+     */
+    int run(const QStringList& arguments);
+
+private:
+    /**
+     * @brief      Collect the map files in a list of files and directories
+     *
+     * @param[in]  paths  The paths
+     *
+     * @return     The map files
+     */
+    QStringList collect_maps(const QStringList& paths) const;
+
+    /**
+     * @brief      Get the file to which a converted or exported map is written
+     *
+     * @param[in]  filename  The filename of the map
+     *
+     * @return     The target filename
+     */
+    QString get_target(const QString& filename) const;
+
+    /**
+     * @brief      Verify that no two maps are written to the same file and
+     *             that no map overwrites itself; conflicts are reported
+     *
+     * @param[in]  filenames  The filenames of the maps
+     *
+     * @return     True if all targets are distinct, False otherwise.
+     */
+    bool check_targets(const QStringList& filenames) const;
+
+    /**
+     * @brief      Process a single map
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     The result
+     */
+    Result process(const QString& filename) const;
+};
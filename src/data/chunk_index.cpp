@@ -0,0 +1,90 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "chunk_index.h"
+
+/**
+ * @brief      Constructs a new instance.
+ */
+ChunkIndex::ChunkIndex() {
+    this->clear();
+}
+
+/**
+ * @brief      Insert a chunk; chunks are never removed individually
+ *
+ * @param[in]  cx        x coordinate of the chunk
+ * @param[in]  cy        y coordinate of the chunk
+ * @param[in]  position  Position of the chunk
+ */
+void ChunkIndex::insert(int cx, int cy, unsigned int position) {
+    // keep the load factor below one half to keep probe sequences short
+    if(2 * (this->count + 1) > this->keys.size()) {
+        this->grow();
+    }
+
+    const uint64_t key = pack(cx, cy);
+    const size_t mask = this->keys.size() - 1;
+    for(size_t i = hash(key) & mask; ; i = (i + 1) & mask) {
+        if(this->values[i] < 0) {
+            this->keys[i] = key;
+            this->values[i] = position;
+            this->count++;
+            return;
+        }
+        if(this->keys[i] == key) {
+            this->values[i] = position;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief      Remove all chunks
+ */
+void ChunkIndex::clear() {
+    this->keys.assign(16, 0);
+    this->values.assign(16, -1);
+    this->count = 0;
+}
+
+/**
+ * @brief      Double the number of buckets and reinsert all chunks
+ */
+void ChunkIndex::grow() {
+    std::vector<uint64_t> old_keys(this->keys.size() * 2, 0);
+    std::vector<int> old_values(this->values.size() * 2, -1);
+    std::swap(old_keys, this->keys);
+    std::swap(old_values, this->values);
+
+    const size_t mask = this->keys.size() - 1;
+    for(size_t j=0; j<old_keys.size(); j++) {
+        if(old_values[j] < 0) {
+            continue;
+        }
+        size_t i = hash(old_keys[j]) & mask;
+        while(this->values[i] >= 0) {
+            i = (i + 1) & mask;
+        }
+        this->keys[i] = old_keys[j];
+        this->values[i] = old_values[j];
+    }
+}
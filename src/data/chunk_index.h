@@ -0,0 +1,105 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @brief      Open-addressing hash table mapping chunk coordinates onto the
+ *             position of the chunk in the chunk array of a map
+ */
+class ChunkIndex {
+private:
+    std::vector<uint64_t> keys;     // packed chunk coordinates
+    std::vector<int> values;        // chunk positions, -1 for an empty bucket
+    size_t count = 0;               // number of occupied buckets
+
+public:
+    /**
+     * @brief      Constructs a new instance.
+     */
+    ChunkIndex();
+
+    /**
+     * @brief      Find the position of a chunk
+     *
+     * @param[in]  cx    x coordinate of the chunk
+     * @param[in]  cy    y coordinate of the chunk
+     *
+     * @return     Position of the chunk, -1 if not present
+     */
+    inline int find(int cx, int cy) const {
+        const uint64_t key = pack(cx, cy);
+        const size_t mask = this->keys.size() - 1;
+        for(size_t i = hash(key) & mask; ; i = (i + 1) & mask) {
+            if(this->values[i] < 0 || this->keys[i] == key) {
+                return this->values[i];
+            }
+        }
+    }
+
+    /**
+     * @brief      Insert a chunk; chunks are never removed individually
+     *
+     * @param[in]  cx        x coordinate of the chunk
+     * @param[in]  cy        y coordinate of the chunk
+     * @param[in]  position  Position of the chunk
+     */
+    void insert(int cx, int cy, unsigned int position);
+
+    /**
+     * @brief      Remove all chunks
+     */
+    void clear();
+
+    /**
+     * @brief      Get the number of chunks
+     *
+     * @return     Number of chunks
+     */
+    inline size_t size() const {
+        return this->count;
+    }
+
+private:
+    /**
+     * @brief      Pack chunk coordinates into a single key
+     */
+    static inline uint64_t pack(int cx, int cy) {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    }
+
+    /**
+     * @brief      Scramble a key (Fibonacci hashing)
+     */
+    static inline size_t hash(uint64_t key) {
+        return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    /**
+     * @brief      Double the number of buckets and reinsert all chunks
+     */
+    void grow();
+};
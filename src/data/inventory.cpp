@@ -0,0 +1,108 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "inventory.h"
+
+/**
+ * @brief      Constructs a new instance without any tiles.
+ *
+ * @param[in]  _tile_manager  The tile manager
+ */
+Inventory::Inventory(const std::shared_ptr<TileManager>& _tile_manager) :
+    tile_manager(_tile_manager),
+    owned(_tile_manager->get_nr_bases(), 0) {
+
+}
+
+/**
+ * @brief      Load the numbers of owned tiles from a file
+ *
+ * @param[in]  filename  The filename
+ */
+void Inventory::load(const QString& filename) {
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Could not open file for reading: " + filename.toStdString());
+    }
+
+    std::vector<size_t> counts(this->owned.size(), 0);
+    unsigned int linenr = 0;
+    while(!file.atEnd()) {
+        const QByteArray line = file.readLine().simplified();
+        linenr++;
+        if(line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        const QList<QByteArray> fields = line.split(' ');
+        bool ok = false;
+        const long long count = fields.size() == 2 ? fields[1].toLongLong(&ok) : 0;
+        if(!ok || count < 0) {
+            throw std::runtime_error("Expected a tile code and a number on line " + std::to_string(linenr) + " of " + filename.toStdString());
+        }
+
+        // any rotation that is present in the catalogue identifies the base tile
+        int tile_id = -1;
+        for(int r=0; r<TILE_ROTATIONS && tile_id < 0; r++) {
+            tile_id = this->tile_manager->get_tile_id(fields[0].toStdString(), r * 60);
+        }
+        if(tile_id < 0) {
+            throw std::runtime_error("Unknown tile " + fields[0].toStdString() + " on line " + std::to_string(linenr) + " of " + filename.toStdString());
+        }
+        counts[this->tile_manager->base_of(tile_id)] += count;
+    }
+
+    this->owned = counts;
+}
+
+/**
+ * @brief      Get the surplus (positive) or shortage (negative) of every
+ *             base tile
+ *
+ * @param[in]  base_counts  The numbers of tiles needed indexed by base id,
+ *                          see TileManager::count_bases
+ *
+ * @return     The balance indexed by base id
+ */
+std::vector<int64_t> Inventory::get_balance(const std::vector<size_t>& base_counts) const {
+    std::vector<int64_t> balance(this->owned.size());
+    for(size_t i=0; i<balance.size(); i++) {
+        balance[i] = (int64_t)this->owned[i] - (int64_t)(i < base_counts.size() ? base_counts[i] : 0);
+    }
+    return balance;
+}
+
+/**
+ * @brief      Whether the inventory holds enough tiles of every base tile
+ *
+ * @param[in]  base_counts  The numbers of tiles needed indexed by base id
+ *
+ * @return     True if all tiles are available, False otherwise.
+ */
+bool Inventory::covers(const std::vector<size_t>& base_counts) const {
+    const size_t nr_bases = std::min(base_counts.size(), this->owned.size());
+    for(size_t i=0; i<nr_bases; i++) {
+        if(base_counts[i] > this->owned[i]) {
+            return false;
+        }
+    }
+    return true;
+}
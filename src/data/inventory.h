@@ -0,0 +1,130 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QFile>
+#include <QByteArray>
+#include <QList>
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+#include "map.h"
+#include "tile_manager.h"
+
+/*
+ * Inventory format, a text file with a line per base tile
+ *
+ *   <tile code> <number of tiles owned>     e.g. "AF02 12"
+ *
+ * Empty lines and lines starting with '#' are ignored; tiles that are not
+ * listed are not owned.
+ */
+class Inventory {
+private:
+    std::shared_ptr<TileManager> tile_manager;
+    std::vector<size_t> owned;      // number of tiles owned per base id
+
+public:
+    /**
+     * @brief      Constructs a new instance without any tiles.
+     *
+     * @param[in]  _tile_manager  The tile manager
+     */
+    Inventory(const std::shared_ptr<TileManager>& _tile_manager);
+
+    /**
+     * @brief      Load the numbers of owned tiles from a file
+     *
+     * @param[in]  filename  The filename
+     */
+    void load(const QString& filename);
+
+    /**
+     * @brief      Get the number of tiles of a base tile that are owned
+     *
+     * @param[in]  base_id  The base identifier
+     *
+     * @return     The number of tiles
+     */
+    inline size_t get_owned(unsigned int base_id) const {
+        return this->owned[base_id];
+    }
+
+    /**
+     * @brief      Get the number of tiles of a base tile on a map, in all
+     *             rotations, from the tile counts kept by the map
+     *
+     * @param[in]  map      The map
+     * @param[in]  base_id  The base identifier
+     *
+     * @return     The number of tiles
+     */
+    inline size_t get_used(const Map& map, unsigned int base_id) const {
+        size_t used = 0;
+        for(int r=0; r<TILE_ROTATIONS; r++) {
+            const int tile_id = this->tile_manager->get_variant(base_id, r);
+            if(tile_id >= 0) {
+                used += map.get_tile_count(tile_id);
+            }
+        }
+        return used;
+    }
+
+    /**
+     * @brief      Whether additional tiles of a base tile can be placed on a
+     *             map without exceeding the inventory
+     *
+     * @param[in]  map      The map
+     * @param[in]  base_id  The base identifier
+     * @param[in]  extra    The number of additional tiles
+     *
+     * @return     True if the tiles are available, False otherwise.
+     */
+    inline bool can_place(const Map& map, unsigned int base_id, size_t extra) const {
+        return this->get_used(map, base_id) + extra <= this->owned[base_id];
+    }
+
+    /**
+     * @brief      Get the surplus (positive) or shortage (negative) of every
+     *             base tile
+     *
+     * @param[in]  base_counts  The numbers of tiles needed indexed by base id,
+     *                          see TileManager::count_bases
+     *
+     * @return     The balance indexed by base id
+     */
+    std::vector<int64_t> get_balance(const std::vector<size_t>& base_counts) const;
+
+    /**
+     * @brief      Whether the inventory holds enough tiles of every base tile
+     *
+     * @param[in]  base_counts  The numbers of tiles needed indexed by base id
+     *
+     * @return     True if all tiles are available, False otherwise.
+     */
+    bool covers(const std::vector<size_t>& base_counts) const;
+};
@@ -0,0 +1,252 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "json_reader.h"
+
+/**
+ * @brief      Constructs a new instance.
+ *
+ * @param[in]  _begin  Start of the document
+ * @param[in]  _end    End of the document
+ */
+JsonReader::JsonReader(const char* _begin, const char* _end) :
+    begin(_begin),
+    end(_end),
+    ptr(_begin) {
+
+}
+
+/**
+ * @brief      Enter an object
+ */
+void JsonReader::begin_object() {
+    this->expect('{');
+    this->first_member = true;
+}
+
+/**
+ * @brief      Read the key of the next member of the current object
+ *
+ * @param[out] key   The key, pointing into the document
+ *
+ * @return     True if a member follows, False if the object has ended.
+ */
+bool JsonReader::next_member(std::string_view* key) {
+    this->skip_whitespace();
+    if(this->ptr < this->end && *this->ptr == '}') {
+        this->ptr++;
+        this->first_member = false;
+        return false;
+    }
+
+    // members after the first one are preceded by a comma; an object that
+    // is continued after a nested object has always read a member already
+    if(!this->first_member) {
+        this->expect(',');
+    }
+    this->first_member = false;
+
+    *key = this->read_string();
+    this->expect(':');
+    return true;
+}
+
+/**
+ * @brief      Read a number
+ *
+ * @return     The number
+ */
+double JsonReader::read_number() {
+    this->skip_whitespace();
+
+    // the number is assembled from its decimal digits, which is independent
+    // of the locale and exact for the short fractions in the tile catalogue
+    bool negative = false;
+    if(this->ptr < this->end && *this->ptr == '-') {
+        negative = true;
+        this->ptr++;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    unsigned int nr_digits = 0;
+    bool fraction = false;
+    for(; this->ptr < this->end; this->ptr++) {
+        const char c = *this->ptr;
+        if(c >= '0' && c <= '9') {
+            if(mantissa < (UINT64_MAX - 9) / 10) {
+                mantissa = mantissa * 10 + (c - '0');
+                exponent -= fraction ? 1 : 0;
+            } else {
+                exponent += fraction ? 0 : 1;
+            }
+            nr_digits++;
+        } else if(c == '.' && !fraction) {
+            fraction = true;
+        } else {
+            break;
+        }
+    }
+    if(nr_digits == 0) {
+        this->error("expected a number");
+    }
+
+    if(this->ptr < this->end && (*this->ptr == 'e' || *this->ptr == 'E')) {
+        this->ptr++;
+        int sign = 1;
+        if(this->ptr < this->end && (*this->ptr == '+' || *this->ptr == '-')) {
+            sign = *this->ptr == '-' ? -1 : 1;
+            this->ptr++;
+        }
+        int value = 0;
+        const char* start = this->ptr;
+        for(; this->ptr < this->end && *this->ptr >= '0' && *this->ptr <= '9'; this->ptr++) {
+            value = std::min(value * 10 + (*this->ptr - '0'), 10000);
+        }
+        if(this->ptr == start) {
+            this->error("expected an exponent");
+        }
+        exponent += sign * value;
+    }
+
+    // a single multiplication or division by an exact power of ten
+    double result = (double)mantissa;
+    double scale = 1.0;
+    for(int i=0; i<std::abs(exponent); i++) {
+        scale *= 10.0;
+    }
+    result = exponent < 0 ? result / scale : result * scale;
+
+    return negative ? -result : result;
+}
+
+/**
+ * @brief      Skip a value of any type
+ */
+void JsonReader::skip_value() {
+    this->skip_whitespace();
+    if(this->ptr == this->end) {
+        this->error("expected a value");
+    }
+
+    switch(*this->ptr) {
+        case '{': {
+            this->begin_object();
+            std::string_view key;
+            while(this->next_member(&key)) {
+                this->skip_value();
+            }
+            break;
+        }
+        case '[': {
+            this->ptr++;
+            this->skip_whitespace();
+            if(this->ptr < this->end && *this->ptr == ']') {
+                this->ptr++;
+                break;
+            }
+            while(true) {
+                this->skip_value();
+                this->skip_whitespace();
+                if(this->ptr < this->end && *this->ptr == ']') {
+                    this->ptr++;
+                    break;
+                }
+                this->expect(',');
+            }
+            break;
+        }
+        case '"':
+            this->read_string();
+            break;
+        case 't':
+        case 'f':
+        case 'n':
+            while(this->ptr < this->end && *this->ptr >= 'a' && *this->ptr <= 'z') {
+                this->ptr++;
+            }
+            break;
+        default:
+            this->read_number();
+            break;
+    }
+}
+
+/**
+ * @brief      Verify that nothing but whitespace follows
+ */
+void JsonReader::finish() {
+    this->skip_whitespace();
+    if(this->ptr != this->end) {
+        this->error("unexpected trailing characters");
+    }
+}
+
+/**
+ * @brief      Advance past spaces, tabs and newlines
+ */
+void JsonReader::skip_whitespace() {
+    while(this->ptr < this->end && (*this->ptr == ' ' || *this->ptr == '\t' || *this->ptr == '\n' || *this->ptr == '\r')) {
+        this->ptr++;
+    }
+}
+
+/**
+ * @brief      Consume a character after optional whitespace
+ *
+ * @param[in]  c     The expected character
+ */
+void JsonReader::expect(char c) {
+    this->skip_whitespace();
+    if(this->ptr == this->end || *this->ptr != c) {
+        this->error(std::string("expected '") + c + "'");
+    }
+    this->ptr++;
+}
+
+/**
+ * @brief      Read a string without escape sequences
+ *
+ * @return     The string, pointing into the document
+ */
+std::string_view JsonReader::read_string() {
+    this->expect('"');
+    const char* start = this->ptr;
+    while(this->ptr < this->end && *this->ptr != '"') {
+        if(*this->ptr == '\\') {
+            this->error("escape sequences are not supported");
+        }
+        this->ptr++;
+    }
+    if(this->ptr == this->end) {
+        this->error("unterminated string");
+    }
+    return std::string_view(start, this->ptr++ - start);
+}
+
+/**
+ * @brief      Throw an error mentioning the current position
+ *
+ * @param[in]  what  Description of the error
+ */
+void JsonReader::error(const std::string& what) const {
+    throw std::runtime_error("JSON error at byte " + std::to_string(this->ptr - this->begin) + ": " + what);
+}
@@ -0,0 +1,108 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+
+/**
+ * @brief      Minimal pull parser for JSON documents held in memory; values
+ *             are read in document order without building a tree
+ */
+class JsonReader {
+private:
+    const char* begin;          // start of the document
+    const char* end;            // end of the document
+    const char* ptr;            // current read position
+    bool first_member = false;  // whether no member of the current object was read yet
+
+public:
+    /**
+     * @brief      Constructs a new instance.
+     *
+     * @param[in]  _begin  Start of the document
+     * @param[in]  _end    End of the document
+     */
+    JsonReader(const char* _begin, const char* _end);
+
+    /**
+     * @brief      Enter an object
+     */
+    void begin_object();
+
+    /**
+     * @brief      Read the key of the next member of the current object
+     *
+     * @param[out] key   The key, pointing into the document
+     *
+     * @return     True if a member follows, False if the object has ended.
+     */
+    bool next_member(std::string_view* key);
+
+    /**
+     * @brief      Read a number
+     *
+     * @return     The number
+     */
+    double read_number();
+
+    /**
+     * @brief      Skip a value of any type
+     */
+    void skip_value();
+
+    /**
+     * @brief      Verify that nothing but whitespace follows
+     */
+    void finish();
+
+private:
+    /**
+     * @brief      Advance past spaces, tabs and newlines
+     */
+    void skip_whitespace();
+
+    /**
+     * @brief      Consume a character after optional whitespace
+     *
+     * @param[in]  c     The expected character
+     */
+    void expect(char c);
+
+    /**
+     * @brief      Read a string without escape sequences
+     *
+     * @return     The string, pointing into the document
+     */
+    std::string_view read_string();
+
+    /**
+     * @brief      Throw an error mentioning the current position
+     *
+     * @param[in]  what  Description of the error
+     */
+    [[noreturn]] void error(const std::string& what) const;
+};
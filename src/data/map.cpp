@@ -34,14 +34,17 @@ Map::Map() {
  * @param[in]  tile_id  The tile identifier
  * @param[in]  x        x coordinate
  * @param[in]  y        y coordinate
- * @param[in]  z        z coordinate
  */
-void Map::add_tile(unsigned int tile_id, int x, int y, int z) {
-	auto pair = std::pair<int, int>(x,y);
-	auto got = this->tiles.find(pair);
-	if(got == this->tiles.end()) {
-		this->tiles.emplace(pair, Tile(tile_id, x, y, z));
-	}
+void Map::add_tile(unsigned int tile_id, int x, int y) {
+    MapChunk& chunk = this->get_or_create_chunk(x, y);
+    const unsigned int i = local_index(x, y);
+    if(chunk.tile_ids[i] == TILE_EMPTY) {
+        chunk.set(i, tile_id);
+        chunk.count++;
+        this->nr_tiles++;
+        this->count_tile(tile_id);
+        this->notify(MapEvent::Inserted, x, y);
+    }
 }
 
 /**
@@ -51,10 +54,19 @@ void Map::add_tile(unsigned int tile_id, int x, int y, int z) {
  * @param[in]  y        y coordinate
  */
 void Map::remove_tile(int x, int y) {
-    auto pair = std::pair<int, int>(x,y);
-    auto got = this->tiles.find(pair);
-    if(got != this->tiles.end()) {
-        this->tiles.erase(pair);
+    const int pos = this->chunk_index.find(x >> CHUNK_BITS, y >> CHUNK_BITS);
+    if(pos < 0) {
+        return;
+    }
+
+    MapChunk& chunk = this->chunks[pos];
+    const unsigned int i = local_index(x, y);
+    if(chunk.tile_ids[i] != TILE_EMPTY) {
+        this->tile_counts[chunk.tile_ids[i]]--;
+        chunk.clear(i);
+        chunk.count--;
+        this->nr_tiles--;
+        this->notify(MapEvent::Removed, x, y);
     }
 }
 
@@ -66,27 +78,71 @@ void Map::remove_tile(int x, int y) {
  * @param[in]  y        y coordinate
  */
 void Map::substitute_tile(unsigned int tile_id, int x, int y) {
-	auto pair = std::pair<int, int>(x,y);
-	auto got = this->tiles.find(pair);
-	if(got != this->tiles.end()) {
-		got->second.tile_id = tile_id;
-	}
+    const int pos = this->chunk_index.find(x >> CHUNK_BITS, y >> CHUNK_BITS);
+    if(pos < 0) {
+        return;
+    }
+
+    uint16_t& cell = this->chunks[pos].tile_ids[local_index(x, y)];
+    if(cell != TILE_EMPTY) {
+        this->tile_counts[cell]--;
+        this->count_tile(tile_id);
+        cell = tile_id;
+        this->notify(MapEvent::Substituted, x, y);
+    }
 }
 
 /**
- * @brief      Get tile id on coordinate, returns -1 on empty
+ * @brief      Register a listener that is notified of every modification
+ *
+ * @param[in]  listener  The listener
+ *
+ * @return     Handle of the listener
+ */
+unsigned int Map::add_listener(const MapListener& listener) {
+    this->listeners.emplace(this->listener_counter, listener);
+    return this->listener_counter++;
+}
+
+/**
+ * @brief      Remove a listener
+ *
+ * @param[in]  handle  Handle of the listener
+ */
+void Map::remove_listener(unsigned int handle) {
+    this->listeners.erase(handle);
+}
+
+/**
+ * @brief      Get the chunk holding a coordinate, creating it when absent
  *
  * @param[in]  x     x coordinate
  * @param[in]  y     y coordinate
  *
- * @return     The tile identifier.
+ * @return     The chunk
+ */
+MapChunk& Map::get_or_create_chunk(int x, int y) {
+    const int cx = x >> CHUNK_BITS;
+    const int cy = y >> CHUNK_BITS;
+    const int pos = this->chunk_index.find(cx, cy);
+    if(pos >= 0) {
+        return this->chunks[pos];
+    }
+
+    this->chunk_index.insert(cx, cy, this->chunks.size());
+    this->chunks.emplace_back(cx, cy);
+    return this->chunks.back();
+}
+
+/**
+ * @brief      Notify all listeners of a modification
+ *
+ * @param[in]  event  The event
+ * @param[in]  x      x coordinate
+ * @param[in]  y      y coordinate
  */
-int Map::get_tile_id(int x, int y) {
-	auto pair = std::pair<int, int>(x,y);
-	auto got = this->tiles.find(pair);
-	if(got != this->tiles.end()) {
-		return got->second.tile_id;
-	} else {
-		return -1;
-	}
+void Map::notify(MapEvent event, int x, int y) const {
+    for(const auto& listener : this->listeners) {
+        listener.second(event, x, y);
+    }
 }
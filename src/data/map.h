@@ -25,25 +25,78 @@
 
 #include <functional>
 #include <vector>
-#include <map>
+#include <array>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 #include "tile.h"
+#include "chunk_index.h"
 
-// custom comparison function
 typedef std::pair<int, int> AxialCoordinate;
-struct ComparisonAxialCoordinate {
-    bool operator()(const AxialCoordinate& a, const AxialCoordinate& b) const {
-        if(a.second == b.second) {
-            return a.first > b.first;
-        } else {
-            return a.second > b.second;
-        }
+
+// custom hash function
+struct HashAxialCoordinate {
+    std::size_t operator()(const AxialCoordinate& a) const {
+        return std::hash<uint64_t>()(((uint64_t)(uint32_t)a.first << 32) | (uint32_t)a.second);
+    }
+};
+
+// type of modification made to a map
+enum class MapEvent {
+    Inserted,
+    Removed,
+    Substituted
+};
+
+// callback that is invoked after a tile on the map has been modified
+typedef std::function<void(MapEvent, int, int)> MapListener;
+
+// tiles are stored in dense chunks of CHUNK_SIZE x CHUNK_SIZE axial coordinates
+constexpr int CHUNK_BITS = 5;
+constexpr int CHUNK_SIZE = 1 << CHUNK_BITS;
+constexpr uint64_t ROW_MASK = ((uint64_t)1 << CHUNK_SIZE) - 1;    // occupancy bits of a row of a chunk
+
+/**
+ * @brief      Dense block of tiles, stored as separate arrays of occupancy bits
+ *             and 16-bit tile ids such that a tile costs two bytes and empty
+ *             parts of a chunk can be skipped quickly
+ */
+struct MapChunk {
+    int cx, cy;                                                 // chunk coordinates
+    unsigned int count = 0;                                     // number of tiles in the chunk
+    std::array<uint64_t, CHUNK_SIZE * CHUNK_SIZE / 64> occupied;  // occupancy bit per cell
+    std::array<uint16_t, CHUNK_SIZE * CHUNK_SIZE> tile_ids;     // tile ids indexed by local (x,y)
+
+    MapChunk(int _cx, int _cy) : cx(_cx), cy(_cy) {
+        this->occupied.fill(0);
+        this->tile_ids.fill(TILE_EMPTY);
+    }
+
+    inline void set(unsigned int i, uint16_t tile_id) {
+        this->occupied[i >> 6] |= (uint64_t)1 << (i & 63);
+        this->tile_ids[i] = tile_id;
+    }
+
+    inline void clear(unsigned int i) {
+        this->occupied[i >> 6] &= ~((uint64_t)1 << (i & 63));
+        this->tile_ids[i] = TILE_EMPTY;
     }
 };
 
 class Map {
 private:
-    std::map<AxialCoordinate, Tile, ComparisonAxialCoordinate> tiles;
+    std::vector<MapChunk> chunks;
+    ChunkIndex chunk_index;
+    size_t nr_tiles = 0;
+    std::vector<size_t> tile_counts;    // number of tiles per tile id, kept up to date on every modification
+
+    std::unordered_map<unsigned int, MapListener> listeners;
+    unsigned int listener_counter = 0;
 
 public:
     /**
@@ -52,12 +105,204 @@ public:
     Map();
 
     /**
-     * @brief      Gets the tiles.
+     * @brief      Get the number of tiles
+     *
+     * @return     The number of tiles
+     */
+    inline size_t size() const {
+        return this->nr_tiles;
+    }
+
+    /**
+     * @brief      Get the number of tiles per tile id; tile ids beyond the
+     *             end of the vector do not occur on the map
+     *
+     * @return     The tile counts
+     */
+    inline const std::vector<size_t>& get_tile_counts() const {
+        return this->tile_counts;
+    }
+
+    /**
+     * @brief      Get the number of tiles with a tile id
+     *
+     * @param[in]  tile_id  The tile identifier
+     *
+     * @return     The number of tiles
+     */
+    inline size_t get_tile_count(unsigned int tile_id) const {
+        return tile_id < this->tile_counts.size() ? this->tile_counts[tile_id] : 0;
+    }
+
+    /**
+     * @brief      Visit all tiles in storage order, which is the fastest way
+     *             to traverse the map
+     *
+     * @param[in]  f     Function accepting a const Tile&
+     */
+    template <typename Function>
+    void for_each_tile(Function f) const {
+        for(const auto& chunk : this->chunks) {
+            if(chunk.count == 0) {
+                continue;
+            }
+            for(unsigned int w=0; w<chunk.occupied.size(); w++) {
+                for(uint64_t bits = chunk.occupied[w]; bits != 0; bits &= bits - 1) {
+                    const unsigned int i = (w << 6) + count_trailing_zeros(bits);
+                    const int x = chunk.cx * CHUNK_SIZE + (i & (CHUNK_SIZE - 1));
+                    const int y = chunk.cy * CHUNK_SIZE + (i >> CHUNK_BITS);
+                    f(Tile(chunk.tile_ids[i], x, y));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief      Get the number of chunks; chunks keep their position until
+     *             the map is destroyed
+     *
+     * @return     The number of chunks
+     */
+    inline size_t get_nr_chunks() const {
+        return this->chunks.size();
+    }
+
+    /**
+     * @brief      Get a chunk by its position
+     *
+     * @param[in]  pos   Position of the chunk
+     *
+     * @return     The chunk
+     */
+    inline const MapChunk& get_chunk(unsigned int pos) const {
+        return this->chunks[pos];
+    }
+
+    /**
+     * @brief      Get the position of the chunk holding a coordinate
+     *
+     * @param[in]  x     x coordinate
+     * @param[in]  y     y coordinate
+     *
+     * @return     Position of the chunk, -1 if not present
+     */
+    inline int find_chunk(int x, int y) const {
+        return this->chunk_index.find(x >> CHUNK_BITS, y >> CHUNK_BITS);
+    }
+
+    /**
+     * @brief      Visit all non-empty chunks that overlap a rectangle of axial
+     *             coordinates; the chunks are looked up in the chunk index
+     *             unless the rectangle spans more chunks than the map holds
      *
-     * @return     The tiles.
+     * @param[in]  xmin  Minimum x coordinate
+     * @param[in]  xmax  Maximum x coordinate
+     * @param[in]  ymin  Minimum y coordinate
+     * @param[in]  ymax  Maximum y coordinate
+     * @param[in]  f     Function accepting the position of the chunk and a
+     *                   const MapChunk&
      */
-    inline const auto& get_tiles() const {
-        return this->tiles;
+    template <typename Function>
+    void for_each_chunk_in(int xmin, int xmax, int ymin, int ymax, Function f) const {
+        const int cxmin = xmin >> CHUNK_BITS;
+        const int cxmax = xmax >> CHUNK_BITS;
+        const int cymin = ymin >> CHUNK_BITS;
+        const int cymax = ymax >> CHUNK_BITS;
+        if(cxmin > cxmax || cymin > cymax) {
+            return;
+        }
+
+        const long long area = (long long)(cxmax - cxmin + 1) * (long long)(cymax - cymin + 1);
+        if(area > (long long)this->chunks.size()) {
+            for(unsigned int pos=0; pos<this->chunks.size(); pos++) {
+                const MapChunk& chunk = this->chunks[pos];
+                if(chunk.count != 0 && chunk.cx >= cxmin && chunk.cx <= cxmax &&
+                   chunk.cy >= cymin && chunk.cy <= cymax) {
+                    f(pos, chunk);
+                }
+            }
+        } else {
+            for(int cy=cymin; cy<=cymax; cy++) {
+                for(int cx=cxmin; cx<=cxmax; cx++) {
+                    const int pos = this->chunk_index.find(cx, cy);
+                    if(pos >= 0 && this->chunks[pos].count != 0) {
+                        f((unsigned int)pos, this->chunks[pos]);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief      Visit all tiles within a rectangle of axial coordinates
+     *
+     * @param[in]  xmin  Minimum x coordinate
+     * @param[in]  xmax  Maximum x coordinate
+     * @param[in]  ymin  Minimum y coordinate
+     * @param[in]  ymax  Maximum y coordinate
+     * @param[in]  f     Function accepting a const Tile&
+     */
+    template <typename Function>
+    void for_each_tile_in(int xmin, int xmax, int ymin, int ymax, Function f) const {
+        this->for_each_chunk_in(xmin, xmax, ymin, ymax, [&](unsigned int, const MapChunk& chunk) {
+            for(unsigned int w=0; w<chunk.occupied.size(); w++) {
+                for(uint64_t bits = chunk.occupied[w]; bits != 0; bits &= bits - 1) {
+                    const unsigned int i = (w << 6) + count_trailing_zeros(bits);
+                    const int x = chunk.cx * CHUNK_SIZE + (i & (CHUNK_SIZE - 1));
+                    const int y = chunk.cy * CHUNK_SIZE + (i >> CHUNK_BITS);
+                    if(x >= xmin && x <= xmax && y >= ymin && y <= ymax) {
+                        f(Tile(chunk.tile_ids[i], x, y));
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief      Visit all tiles in deterministic row order, i.e. descending
+     *             y and, within a row, descending x
+     *
+     * @param[in]  f     Function accepting a const Tile&
+     */
+    template <typename Function>
+    void for_each_tile_ordered(Function f) const {
+        // sort the chunks on descending chunk row and column
+        std::vector<const MapChunk*> sorted;
+        sorted.reserve(this->chunks.size());
+        for(const auto& chunk : this->chunks) {
+            if(chunk.count != 0) {
+                sorted.push_back(&chunk);
+            }
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const MapChunk* a, const MapChunk* b) {
+            return a->cy != b->cy ? a->cy > b->cy : a->cx > b->cx;
+        });
+
+        // walk each row of chunks line by line
+        for(size_t first=0; first<sorted.size(); ) {
+            size_t last = first;
+            while(last < sorted.size() && sorted[last]->cy == sorted[first]->cy) {
+                last++;
+            }
+            for(int ly=CHUNK_SIZE-1; ly>=0; ly--) {
+                for(size_t c=first; c<last; c++) {
+                    const MapChunk* chunk = sorted[c];
+                    const unsigned int row = ly << CHUNK_BITS;
+                    if(((chunk->occupied[row >> 6] >> (row & 63)) & ROW_MASK) == 0) {
+                        continue;
+                    }
+                    for(int lx=CHUNK_SIZE-1; lx>=0; lx--) {
+                        const uint16_t tile_id = chunk->tile_ids[row + lx];
+                        if(tile_id != TILE_EMPTY) {
+                            const int x = chunk->cx * CHUNK_SIZE + lx;
+                            const int y = chunk->cy * CHUNK_SIZE + ly;
+                            f(Tile(tile_id, x, y));
+                        }
+                    }
+                }
+            }
+            first = last;
+        }
     }
 
     /**
@@ -66,9 +311,8 @@ public:
      * @param[in]  tile_id  The tile identifier
      * @param[in]  x        x coordinate
      * @param[in]  y        y coordinate
-     * @param[in]  z        z coordinate
      */
-    void add_tile(unsigned int tile_id, int x, int y, int z);
+    void add_tile(unsigned int tile_id, int x, int y);
 
     /**
      * @brief      Remove a tile
@@ -95,7 +339,89 @@ public:
      *
      * @return     The tile identifier.
      */
-    int get_tile_id(int x, int y);
+    inline int get_tile_id(int x, int y) const {
+        const int pos = this->chunk_index.find(x >> CHUNK_BITS, y >> CHUNK_BITS);
+        if(pos < 0) {
+            return -1;
+        }
+        const uint16_t tile_id = this->chunks[pos].tile_ids[local_index(x, y)];
+        return tile_id == TILE_EMPTY ? -1 : tile_id;
+    }
+
+    /**
+     * @brief      Register a listener that is notified of every modification
+     *
+     * @param[in]  listener  The listener
+     *
+     * @return     Handle of the listener
+     */
+    unsigned int add_listener(const MapListener& listener);
+
+    /**
+     * @brief      Remove a listener
+     *
+     * @param[in]  handle  Handle of the listener
+     */
+    void remove_listener(unsigned int handle);
+
+    /**
+     * @brief      Get the position of a tile within its chunk
+     *
+     * @param[in]  x     x coordinate
+     * @param[in]  y     y coordinate
+     *
+     * @return     Position within the chunk
+     */
+    static inline unsigned int local_index(int x, int y) {
+        return ((y & (CHUNK_SIZE - 1)) << CHUNK_BITS) + (x & (CHUNK_SIZE - 1));
+    }
 
 private:
+    /**
+     * @brief      Get the position of the lowest set bit
+     *
+     * @param[in]  bits  Non-zero bit field
+     *
+     * @return     Position of the lowest set bit
+     */
+    static inline unsigned int count_trailing_zeros(uint64_t bits) {
+#ifdef _MSC_VER
+        unsigned long pos;
+        _BitScanForward64(&pos, bits);
+        return pos;
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+
+    /**
+     * @brief      Get the chunk holding a coordinate, creating it when absent
+     *
+     * @param[in]  x     x coordinate
+     * @param[in]  y     y coordinate
+     *
+     * @return     The chunk
+     */
+    MapChunk& get_or_create_chunk(int x, int y);
+
+    /**
+     * @brief      Increment the number of tiles with a tile id
+     *
+     * @param[in]  tile_id  The tile identifier
+     */
+    inline void count_tile(unsigned int tile_id) {
+        if(tile_id >= this->tile_counts.size()) {
+            this->tile_counts.resize(tile_id + 1, 0);
+        }
+        this->tile_counts[tile_id]++;
+    }
+
+    /**
+     * @brief      Notify all listeners of a modification
+     *
+     * @param[in]  event  The event
+     * @param[in]  x      x coordinate
+     * @param[in]  y      y coordinate
+     */
+    void notify(MapEvent event, int x, int y) const;
 };
@@ -0,0 +1,114 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "map_fragment.h"
+
+/**
+ * @brief      Constructs a new instance.
+ *
+ * @param[in]  _tiles  The tiles
+ */
+MapFragment::MapFragment(std::vector<FragmentTile> _tiles) :
+    tiles(std::move(_tiles)) {
+
+}
+
+/**
+ * @brief      Copy the tiles on a set of cells of a map
+ *
+ * @param[in]  map    The map
+ * @param[in]  cells  The cells, empty cells are skipped
+ * @param[in]  x      x coordinate of the anchor
+ * @param[in]  y      y coordinate of the anchor
+ *
+ * @return     The fragment
+ */
+std::shared_ptr<const MapFragment> MapFragment::copy(const Map& map, const std::vector<AxialCoordinate>& cells, int x, int y) {
+    static const long long limit = std::numeric_limits<int16_t>::max();
+
+    std::vector<FragmentTile> tiles;
+    for(const auto& cell : cells) {
+        const int tile_id = map.get_tile_id(cell.first, cell.second);
+        if(tile_id < 0) {
+            continue;
+        }
+
+        const long long dx = (long long)cell.first - x;
+        const long long dy = (long long)cell.second - y;
+        const long long dz = -dx - dy;
+
+        // all three cube coordinates are bounded, as rotations exchange them
+        if(std::max({dx, dy, dz}) > limit || std::min({dx, dy, dz}) < -limit) {
+            throw std::runtime_error("Fragment exceeds the maximum extent of " + std::to_string(limit) + " tiles");
+        }
+        tiles.push_back(FragmentTile{(int16_t)dx, (int16_t)dy, (uint16_t)tile_id});
+    }
+
+    return std::make_shared<const MapFragment>(std::move(tiles));
+}
+
+/**
+ * @brief      Get a copy of this fragment rotated around its anchor
+ *
+ * @param[in]  tile_manager  The tile manager, used to rotate the tiles
+ * @param[in]  steps         Number of counterclockwise steps of 60 degrees,
+ *                           matching TileManager::rotate
+ *
+ * @return     The rotated fragment
+ */
+std::shared_ptr<const MapFragment> MapFragment::rotate(const TileManager& tile_manager, int steps) const {
+    const int turns = ((steps % TILE_ROTATIONS) + TILE_ROTATIONS) % TILE_ROTATIONS;
+
+    std::vector<FragmentTile> rotated(this->tiles);
+    for(FragmentTile& tile : rotated) {
+        // a counterclockwise step maps the cube coordinates (x,y,z) onto
+        // (-y,-z,-x), which is the direction in which the tiles rotate
+        int x = tile.dx;
+        int y = tile.dy;
+        for(int i=0; i<turns; i++) {
+            const int z = -x - y;
+            x = -y;
+            y = -z;
+        }
+        tile.dx = x;
+        tile.dy = y;
+        tile.tile_id = tile_manager.rotate(tile.tile_id, turns);
+    }
+
+    return std::make_shared<const MapFragment>(std::move(rotated));
+}
+
+/**
+ * @brief      Place the tiles on a map as a single transaction, replacing
+ *             the tiles that are already present
+ *
+ * @param      map      The map
+ * @param      journal  The journal of the map
+ * @param[in]  x        x coordinate of the anchor
+ * @param[in]  y        y coordinate of the anchor
+ */
+void MapFragment::paste(Map& map, MapJournal& journal, int x, int y) const {
+    journal.begin_transaction();
+    for(const FragmentTile& tile : this->tiles) {
+        journal.set_tile(map, x + tile.dx, y + tile.dy, tile.tile_id);
+    }
+    journal.end_transaction();
+}
@@ -0,0 +1,109 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+#include <string>
+
+#include "map.h"
+#include "map_journal.h"
+#include "tile_manager.h"
+
+/**
+ * @brief      Tile of a fragment relative to the anchor of the fragment
+ */
+struct FragmentTile {
+    int16_t dx, dy;     // axial offset from the anchor
+    uint16_t tile_id;
+};
+
+/**
+ * @brief      Immutable group of tiles copied from a map, which can be placed
+ *             onto any map at any position
+ *
+ *             Fragments are handed out as shared pointers to const, such that
+ *             the clipboard, the stamp library and every paste share the same
+ *             tile data instead of copying it.
+ */
+class MapFragment {
+private:
+    std::vector<FragmentTile> tiles;
+
+public:
+    /**
+     * @brief      Constructs a new instance.
+     *
+     * @param[in]  _tiles  The tiles
+     */
+    MapFragment(std::vector<FragmentTile> _tiles);
+
+    /**
+     * @brief      Copy the tiles on a set of cells of a map
+     *
+     * @param[in]  map    The map
+     * @param[in]  cells  The cells, empty cells are skipped
+     * @param[in]  x      x coordinate of the anchor
+     * @param[in]  y      y coordinate of the anchor
+     *
+     * @return     The fragment
+     */
+    static std::shared_ptr<const MapFragment> copy(const Map& map, const std::vector<AxialCoordinate>& cells, int x, int y);
+
+    /**
+     * @brief      Get a copy of this fragment rotated around its anchor
+     *
+     * @param[in]  tile_manager  The tile manager, used to rotate the tiles
+     * @param[in]  steps         Number of counterclockwise steps of 60 degrees,
+     *                           matching TileManager::rotate
+     *
+     * @return     The rotated fragment
+     */
+    std::shared_ptr<const MapFragment> rotate(const TileManager& tile_manager, int steps) const;
+
+    /**
+     * @brief      Place the tiles on a map as a single transaction, replacing
+     *             the tiles that are already present
+     *
+     * @param      map      The map
+     * @param      journal  The journal of the map
+     * @param[in]  x        x coordinate of the anchor
+     * @param[in]  y        y coordinate of the anchor
+     */
+    void paste(Map& map, MapJournal& journal, int x, int y) const;
+
+    inline const std::vector<FragmentTile>& get_tiles() const {
+        return this->tiles;
+    }
+
+    inline size_t size() const {
+        return this->tiles.size();
+    }
+
+    inline bool empty() const {
+        return this->tiles.empty();
+    }
+};
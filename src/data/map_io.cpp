@@ -30,53 +30,319 @@ MapIO::MapIO(const std::shared_ptr<TileManager>& _tile_manager) :
 }
 
 /**
- * @brief      Load map from file
+ * @brief      Load map from file, the format is deduced from the extension
  *
  * @param[in]  filename  The filename
+ * @param      monitor   Optional progress monitor
  *
- * @return     shared pointer to map
+ * @return     shared pointer to map, nullptr if the load was cancelled
  */
-std::shared_ptr<Map> MapIO::load(const QString& filename) {
-    std::ifstream infile(filename.toStdString());
+std::shared_ptr<Map> MapIO::load(const QString& filename, LoadMonitor* monitor) {
+    if(is_binary(filename)) {
+        return this->load_binary(filename, monitor);
+    } else {
+        return this->load_text(filename, monitor);
+    }
+}
+
+/**
+ * @brief      Save map to filename, the format is deduced from the extension
+ *
+ * @param[in]  filename  The filename
+ */
+void MapIO::save(const std::shared_ptr<Map>& map, const QString& filename) {
+    this->save_tiles(this->take_snapshot(map), filename);
+}
+
+/**
+ * @brief      Save map to filename on a background thread; the tiles are
+ *             copied on the calling thread such that the map can be
+ *             modified while the file is being written
+ *
+ * @param[in]  map       The map
+ * @param[in]  filename  The filename
+ *
+ * @return     future holding an error message, empty on success
+ */
+QFuture<QString> MapIO::save_async(const std::shared_ptr<Map>& map, const QString& filename) {
+    auto tiles = std::make_shared<const std::vector<Tile>>(this->take_snapshot(map));
+    MapIO io(this->tile_manager);
+
+    return QtConcurrent::run([io, tiles, filename]() {
+        try {
+            io.save_tiles(*tiles, filename);
+        } catch(const std::exception& e) {
+            return QString(e.what());
+        }
+        return QString();
+    });
+}
+
+/**
+ * @brief      Load map from a text (.htm) file
+ *
+ * @param[in]  filename  The filename
+ * @param      monitor   Optional progress monitor
+ *
+ * @return     shared pointer to map, nullptr if the load was cancelled
+ */
+std::shared_ptr<Map> MapIO::load_text(const QString& filename, LoadMonitor* monitor) {
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Could not open file: " + filename.toStdString());
+    }
 
-    std::string line;
     auto map = std::make_shared<Map>();
-    while(std::getline(infile, line)) {
-        boost::trim(line);
-        std::vector<std::string> pieces;
-        boost::split(pieces, line, boost::is_any_of("\t "), boost::token_compress_on);
+    const size_t filesize = file.size();
+    if(filesize == 0) {
+        return map;
+    }
+
+    const char* data = (const char*)file.map(0, filesize);
+    if(data == nullptr) {
+        throw std::runtime_error("Could not read file: " + filename.toStdString());
+    }
+
+    // divide the file into blocks that end on a line boundary; small files
+    // are parsed as a single block
+    const char* end = data + filesize;
+    std::vector<const char*> bounds = {data};
+    size_t nr_blocks = 1;
+#ifdef _OPENMP
+    if(filesize > parallel_threshold) {
+        nr_blocks = 4 * omp_get_max_threads();
+    }
+#endif
+    for(size_t i=1; i<nr_blocks; i++) {
+        const char* ptr = data + filesize * i / nr_blocks;
+        if(ptr < bounds.back()) {
+            continue;
+        }
+        ptr = (const char*)std::memchr(ptr, '\n', end - ptr);
+        if(ptr == nullptr || ptr + 1 == end) {
+            break;
+        }
+        bounds.push_back(ptr + 1);
+    }
+    bounds.push_back(end);
+
+    // every byte is counted once when parsed and once when merged
+    if(monitor != nullptr) {
+        monitor->work_total = 2 * filesize;
+    }
 
-        std::string name = pieces[0];
-        std::string angle = pieces[1];
-        int x = boost::lexical_cast<int>(pieces[2]);
-        int y = boost::lexical_cast<int>(pieces[3]);
-        int z = boost::lexical_cast<int>(pieces[4]);
-        int tile_id = this->tile_manager->get_tile_id(name + "_" + angle);
+    // parse all blocks concurrently
+    std::vector<ParsedBlock> blocks(bounds.size() - 1);
+    std::atomic<bool> cancelled{false};
+    #pragma omp parallel for schedule(dynamic)
+    for(int i=0; i<(int)blocks.size(); i++) {
+        if(cancelled) {
+            continue;
+        }
+        this->parse_block(bounds[i], bounds[i+1], &blocks[i]);
+        if(advance(monitor, bounds[i+1] - bounds[i])) {
+            cancelled = true;
+        }
+    }
 
-        map->add_tile(tile_id, x, y, z);
+    // merge the blocks in file order, such that the first occurrence of a
+    // coordinate wins just as for a sequential load
+    size_t lineno = 0;
+    for(size_t i=0; i<blocks.size() && !cancelled; i++) {
+        const ParsedBlock& block = blocks[i];
+        if(!block.error.empty()) {
+            throw std::runtime_error(filename.toStdString() + ":" + std::to_string(lineno + block.error_line) + ": " + block.error);
+        }
+        for(const Tile& tile : block.tiles) {
+            map->add_tile(tile.tile_id, tile.x, tile.y);
+        }
+        lineno += block.nr_lines;
+        cancelled = advance(monitor, bounds[i+1] - bounds[i]);
     }
 
-    infile.close();
+    file.unmap((uchar*)data);
+    file.close();
+
+    if(cancelled) {
+        return nullptr;
+    }
 
     return map;
 }
 
 /**
- * @brief      Save map to filename
+ * @brief      Parse a block of complete lines of a text (.htm) file
+ *
+ * @param[in]  begin  Start of the block
+ * @param[in]  end    End of the block
+ * @param[out] block  The parsed tiles, or the line of the first error
+ */
+void MapIO::parse_block(const char* begin, const char* end, ParsedBlock* block) const {
+    block->tiles.reserve((end - begin) / 24);
+
+    for(const char* ptr = begin; ptr < end; ) {
+        const char* eol = (const char*)std::memchr(ptr, '\n', end - ptr);
+        if(eol == nullptr) {
+            eol = end;
+        }
+        block->nr_lines++;
+
+        Tile tile(0, 0, 0);
+        try {
+            if(this->parse_line(ptr, eol, &tile)) {
+                block->tiles.push_back(tile);
+            }
+        } catch(const std::exception& e) {
+            block->error_line = block->nr_lines;
+            block->error = e.what();
+            return;
+        }
+
+        ptr = eol + 1;
+    }
+}
+
+/**
+ * @brief      Parse a single line of a text (.htm) file
+ *
+ * @param[in]  begin  Start of the line
+ * @param[in]  end    End of the line (excluding the newline)
+ * @param[out] tile   The parsed tile
+ *
+ * @return     True if a tile was parsed, False for a blank line.
+ */
+bool MapIO::parse_line(const char* begin, const char* end, Tile* tile) const {
+    std::string_view fields[5];
+    unsigned int nr_fields = 0;
+
+    // split on spaces and tabs; a carriage return is treated as whitespace
+    const char* ptr = begin;
+    while(true) {
+        while(ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\r')) {
+            ptr++;
+        }
+        if(ptr == end) {
+            break;
+        }
+        const char* token = ptr;
+        while(ptr < end && *ptr != ' ' && *ptr != '\t' && *ptr != '\r') {
+            ptr++;
+        }
+        if(nr_fields == 5) {
+            throw std::runtime_error("expected 5 fields, found more");
+        }
+        fields[nr_fields++] = std::string_view(token, ptr - token);
+    }
+
+    if(nr_fields == 0) {
+        return false;
+    }
+    if(nr_fields != 5) {
+        throw std::runtime_error("expected 5 fields, found " + std::to_string(nr_fields));
+    }
+
+    const unsigned int angle = parse_integer<unsigned int>(fields[1]);
+    const int x = parse_integer<int>(fields[2]);
+    const int y = parse_integer<int>(fields[3]);
+    const int z = parse_integer<int>(fields[4]);
+    if(x + y + z != 0) {
+        throw std::runtime_error("invalid cubic coordinate");
+    }
+
+    const int tile_id = this->tile_manager->get_tile_id(fields[0], angle);
+    if(tile_id < 0) {
+        throw std::runtime_error("unknown tile " + std::string(fields[0]) + " " + std::string(fields[1]));
+    }
+
+    *tile = Tile(tile_id, x, y);
+    return true;
+}
+
+/**
+ * @brief      Copy all tiles of a map in the order in which they are saved
+ *
+ * @param[in]  map   The map
+ *
+ * @return     The tiles
+ */
+std::vector<Tile> MapIO::take_snapshot(const std::shared_ptr<Map>& map) const {
+    std::vector<Tile> tiles;
+    tiles.reserve(map->size());
+    map->for_each_tile_ordered([&tiles](const Tile& tile) {
+        tiles.push_back(tile);
+    });
+    return tiles;
+}
+
+/**
+ * @brief      Save tiles to filename, the format is deduced from the extension
  *
+ * @param[in]  tiles     The tiles
  * @param[in]  filename  The filename
  */
-void MapIO::save(const std::shared_ptr<Map>& map, const QString& filename) {
-    std::ofstream outfile(filename.toStdString());
+void MapIO::save_tiles(const std::vector<Tile>& tiles, const QString& filename) const {
+    if(is_binary(filename)) {
+        this->save_binary(tiles, filename);
+    } else {
+        this->save_text(tiles, filename);
+    }
+}
+
+/**
+ * @brief      Save tiles to a text (.htm) file
+ *
+ * @param[in]  tiles     The tiles
+ * @param[in]  filename  The filename
+ */
+void MapIO::save_text(const std::vector<Tile>& tiles, const QString& filename) const {
+    QSaveFile file(filename);
+    if(!file.open(QIODevice::WriteOnly)) {
+        throw std::runtime_error("Could not open file for writing: " + filename.toStdString());
+    }
+
+    // the tile code and angle of every tile type are formatted only once
+    std::vector<std::string> prefixes;
 
-    for(const auto& tile : map->get_tiles()) {
-        std::string name = this->tile_manager->get_tilename(tile.second.tile_id);
-        std::string tilecode = name.substr(0,4);
-        int angle = boost::lexical_cast<int>(name.substr(name.size() - 3, 3));
-        outfile << (boost::format("%s  %03i  %+04i  %+04i  %+04i\n") % tilecode % angle % tile.second.x % tile.second.y % tile.second.z).str();
+    // lines are formatted into a reusable buffer that is flushed when full
+    std::vector<char> buffer(write_buffer_size);
+    char* ptr = &buffer[0];
+    for(const Tile& tile : tiles) {
+        if(tile.tile_id >= prefixes.size()) {
+            prefixes.resize(tile.tile_id + 1);
+        }
+        std::string& prefix = prefixes[tile.tile_id];
+        if(prefix.empty()) {
+            const unsigned int angle = this->tile_manager->rotation_of(tile.tile_id) * 60;
+            prefix = this->tile_manager->get_base_code(this->tile_manager->base_of(tile.tile_id)) + "  ";
+            prefix += angle < 100 ? (angle < 10 ? "00" : "0") : "";
+            prefix += std::to_string(angle) + "  ";
+        }
+
+        // a line holds the prefix and at most three coordinates of 12 characters
+        const size_t max_line = prefix.size() + 3 * 14 + 1;
+        if((size_t)(&buffer[0] + buffer.size() - ptr) < max_line) {
+            write_buffer(file, &buffer[0], ptr - &buffer[0]);
+            if(buffer.size() < max_line) {
+                buffer.resize(max_line);
+            }
+            ptr = &buffer[0];
+        }
+
+        ptr = std::copy(prefix.begin(), prefix.end(), ptr);
+        ptr = format_coordinate(ptr, tile.x);
+        *ptr++ = ' ';
+        *ptr++ = ' ';
+        ptr = format_coordinate(ptr, tile.y);
+        *ptr++ = ' ';
+        *ptr++ = ' ';
+        ptr = format_coordinate(ptr, tile.z());
+        *ptr++ = '\n';
     }
+    write_buffer(file, &buffer[0], ptr - &buffer[0]);
 
-    outfile.close();
+    if(!file.commit()) {
+        throw std::runtime_error("Could not write file: " + filename.toStdString());
+    }
 }
 
 /**
@@ -87,26 +353,187 @@ void MapIO::save(const std::shared_ptr<Map>& map, const QString& filename) {
 QString MapIO::build_bom(const std::shared_ptr<Map>& map) const {
     QString result;
 
-    std::unordered_map<std::string, unsigned int> tiles;
-    std::vector<std::string> tilenames;
+    // count per base tile, i.e. irrespective of rotation; the map keeps
+    // track of the number of tiles per tile id
+    const std::vector<size_t> counts = this->tile_manager->count_bases(map->get_tile_counts());
 
-    for(const auto& tile : map->get_tiles()) {
-        std::string name = this->tile_manager->get_tilename(tile.second.tile_id).substr(0,4);
-        auto got = tiles.find(name);
-        if(got != tiles.end()) {
-            got->second++;
-        } else {
-            tilenames.push_back(name);
-            tiles.emplace(name, 1);
+    std::vector<unsigned int> base_ids;
+    for(unsigned int i=0; i<counts.size(); i++) {
+        if(counts[i] > 0) {
+            base_ids.push_back(i);
         }
     }
+    std::sort(base_ids.begin(), base_ids.end(), [this](unsigned int a, unsigned int b) {
+        return this->tile_manager->get_base_code(a) < this->tile_manager->get_base_code(b);
+    });
 
-    std::sort(tilenames.begin(), tilenames.end());
-
-    for(const auto& tilename : tilenames) {
-        auto got = tiles.find(tilename);
-        result += QString("%1\t%2\n").arg(tilename.c_str()).arg(got->second);
+    for(unsigned int base_id : base_ids) {
+        result += QString("%1\t%2\n").arg(this->tile_manager->get_base_code(base_id).c_str()).arg(counts[base_id]);
     }
 
     return result;
 }
+
+/**
+ * @brief      Whether a file uses the binary map format
+ *
+ * @param[in]  filename  The filename
+ *
+ * @return     True if binary, False otherwise.
+ */
+bool MapIO::is_binary(const QString& filename) {
+    return QFileInfo(filename).suffix().toLower() == "htb";
+}
+
+/**
+ * @brief      Load map from a binary (.htb) file
+ *
+ * @param[in]  filename  The filename
+ * @param      monitor   Optional progress monitor
+ *
+ * @return     shared pointer to map, nullptr if the load was cancelled
+ */
+std::shared_ptr<Map> MapIO::load_binary(const QString& filename, LoadMonitor* monitor) {
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Could not open file: " + filename.toStdString());
+    }
+
+    const size_t filesize = file.size();
+    const uchar* data = filesize > 0 ? file.map(0, filesize) : nullptr;
+    if(data == nullptr || filesize < binary_header_size) {
+        throw std::runtime_error("Invalid binary map file: " + filename.toStdString());
+    }
+
+    // verify header
+    if(std::memcmp(data, binary_magic, 4) != 0) {
+        throw std::runtime_error("Invalid binary map file: " + filename.toStdString());
+    }
+    if(read_uint32(data + 4) != binary_version) {
+        throw std::runtime_error("Unsupported binary map version in: " + filename.toStdString());
+    }
+    const uint32_t nr_names = read_uint32(data + 8);
+    const uint32_t nr_tiles = read_uint32(data + 12);
+
+    // resolve the tile names in the dictionary to tile ids
+    std::vector<unsigned int> tile_ids;
+    tile_ids.reserve(nr_names);
+    size_t pos = binary_header_size;
+    for(uint32_t i=0; i<nr_names; i++) {
+        if(pos >= filesize || pos + 1 + data[pos] > filesize) {
+            throw std::runtime_error("Truncated tile dictionary in: " + filename.toStdString());
+        }
+        const size_t len = data[pos];
+        tile_ids.push_back(this->tile_manager->get_tile_id(std::string((const char*)data + pos + 1, len)));
+        pos += 1 + len;
+    }
+    pos = (pos + 3) & ~(size_t)3;
+
+    if(pos + (size_t)nr_tiles * binary_record_size > filesize) {
+        throw std::runtime_error("Truncated tile records in: " + filename.toStdString());
+    }
+
+    // read the tile records directly from the mapped file, progress is
+    // reported in batches of records
+    static const uint32_t batch_size = 1 << 16;
+    if(monitor != nullptr) {
+        monitor->work_total = nr_tiles;
+    }
+    auto map = std::make_shared<Map>();
+    const uchar* record = data + pos;
+    for(uint32_t i=0; i<nr_tiles; i++, record += binary_record_size) {
+        const int x = (int32_t)read_uint32(record);
+        const int y = (int32_t)read_uint32(record + 4);
+        const uint32_t idx = read_uint32(record + 8);
+        if(idx >= nr_names) {
+            throw std::runtime_error("Invalid tile reference in: " + filename.toStdString());
+        }
+        map->add_tile(tile_ids[idx], x, y);
+
+        if((i + 1) % batch_size == 0 && advance(monitor, batch_size)) {
+            map.reset();
+            break;
+        }
+    }
+    if(map) {
+        advance(monitor, nr_tiles % batch_size);
+    }
+
+    file.unmap(const_cast<uchar*>(data));
+    file.close();
+
+    return map;
+}
+
+/**
+ * @brief      Save tiles to a binary (.htb) file
+ *
+ * @param[in]  tiles     The tiles
+ * @param[in]  filename  The filename
+ */
+void MapIO::save_binary(const std::vector<Tile>& tiles, const QString& filename) const {
+    // build dictionary of the tiles that are used in the map
+    std::vector<int> dictionary_index;
+    std::vector<unsigned int> dictionary;
+    for(const Tile& tile : tiles) {
+        if(tile.tile_id >= dictionary_index.size()) {
+            dictionary_index.resize(tile.tile_id + 1, -1);
+        }
+        if(dictionary_index[tile.tile_id] < 0) {
+            dictionary_index[tile.tile_id] = dictionary.size();
+            dictionary.push_back(tile.tile_id);
+        }
+    }
+
+    std::vector<char> buffer;
+    buffer.reserve(binary_header_size + dictionary.size() * 16 + tiles.size() * binary_record_size);
+
+    // header
+    buffer.insert(buffer.end(), binary_magic, binary_magic + 4);
+    write_uint32(buffer, binary_version);
+    write_uint32(buffer, dictionary.size());
+    write_uint32(buffer, tiles.size());
+
+    // dictionary
+    for(unsigned int tile_id : dictionary) {
+        const std::string& name = this->tile_manager->get_tilename(tile_id);
+        if(name.size() > 255) {
+            throw std::runtime_error("Tile name too long for binary map format: " + name);
+        }
+        buffer.push_back((char)name.size());
+        buffer.insert(buffer.end(), name.begin(), name.end());
+    }
+    while(buffer.size() % 4 != 0) {
+        buffer.push_back(0);
+    }
+
+    // records
+    for(const Tile& tile : tiles) {
+        write_uint32(buffer, (uint32_t)tile.x);
+        write_uint32(buffer, (uint32_t)tile.y);
+        write_uint32(buffer, dictionary_index[tile.tile_id]);
+    }
+
+    QSaveFile file(filename);
+    if(!file.open(QIODevice::WriteOnly)) {
+        throw std::runtime_error("Could not open file for writing: " + filename.toStdString());
+    }
+    write_buffer(file, &buffer[0], buffer.size());
+    if(!file.commit()) {
+        throw std::runtime_error("Could not write file: " + filename.toStdString());
+    }
+}
+
+/**
+ * @brief      Write a buffer to a file that is only replaced once all data
+ *             has been written successfully
+ *
+ * @param      file    The file
+ * @param[in]  data    The data
+ * @param[in]  size    The size of the data
+ */
+void MapIO::write_buffer(QSaveFile& file, const char* data, size_t size) {
+    if(size > 0 && file.write(data, size) != (qint64)size) {
+        file.cancelWriting();
+    }
+}
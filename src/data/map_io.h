@@ -22,21 +22,79 @@
 #pragma once
 
 #include <QString>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrent>
 
 #include <memory>
-#include <fstream>
+#include <atomic>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <string_view>
+#include <charconv>
+#include <stdexcept>
+#include <algorithm>
 
-#include <boost/format.hpp>
-#include <boost/lexical_cast.hpp>
-#include <boost/algorithm/string.hpp>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "tile_manager.h"
 #include "map.h"
 
+/*
+ * Binary map format (.htb), all integers are stored as little-endian
+ *
+ *   header       char[4]   magic "HTMB"
+ *                uint32    format version
+ *                uint32    number of tile names in the dictionary
+ *                uint32    number of tile records
+ *   dictionary   per name: uint8 length followed by the characters of the
+ *                tile name (e.g. "AF01_060"); the names are stored back to
+ *                back and the dictionary as a whole is padded with zeros
+ *                such that the records start at a multiple of four bytes
+ *   records      per tile: int32 x, int32 y, uint32 dictionary index
+ */
 class MapIO {
+public:
+    /**
+     * @brief      Progress of a load running on another thread; the loading
+     *             thread advances work_done up to work_total and any thread
+     *             may request cancellation
+     */
+    struct LoadMonitor {
+        std::atomic<size_t> work_done{0};
+        std::atomic<size_t> work_total{0};
+        std::atomic<bool> cancelled{false};
+    };
+
 private:
     std::shared_ptr<TileManager> tile_manager;
 
+    static constexpr char binary_magic[4] = {'H', 'T', 'M', 'B'};
+    static constexpr uint32_t binary_version = 1;
+    static constexpr size_t binary_header_size = 16;
+    static constexpr size_t binary_record_size = 12;
+
+    // text files larger than this are parsed in parallel
+    static constexpr size_t parallel_threshold = 1 << 20;
+
+    // size of the buffer in which text files are formatted before writing
+    static constexpr size_t write_buffer_size = 1 << 20;
+
+    /**
+     * @brief      Result of parsing a block of lines of a text file
+     */
+    struct ParsedBlock {
+        std::vector<Tile> tiles;    // tiles in order of appearance
+        size_t nr_lines = 0;        // number of lines in the block
+        size_t error_line = 0;      // line within the block of the first error
+        std::string error;          // description of the first error, empty if none
+    };
+
 public:
     /**
      * @brief      Constructs a new instance.
@@ -44,21 +102,34 @@ public:
     MapIO(const std::shared_ptr<TileManager>& _tile_manager);
 
     /**
-     * @brief      Load map from file
+     * @brief      Load map from file, the format is deduced from the extension
      *
      * @param[in]  filename  The filename
+     * @param      monitor   Optional progress monitor
      *
-     * @return     shared pointer to map
+     * @return     shared pointer to map, nullptr if the load was cancelled
      */
-    std::shared_ptr<Map> load(const QString& filename);
+    std::shared_ptr<Map> load(const QString& filename, LoadMonitor* monitor = nullptr);
 
     /**
-     * @brief      Save map to filename
+     * @brief      Save map to filename, the format is deduced from the extension
      *
      * @param[in]  filename  The filename
      */
     void save(const std::shared_ptr<Map>& map, const QString& filename);
 
+    /**
+     * @brief      Save map to filename on a background thread; the tiles are
+     *             copied on the calling thread such that the map can be
+     *             modified while the file is being written
+     *
+     * @param[in]  map       The map
+     * @param[in]  filename  The filename
+     *
+     * @return     future holding an error message, empty on success
+     */
+    QFuture<QString> save_async(const std::shared_ptr<Map>& map, const QString& filename);
+
     /**
      * @brief      Build the bill of materials
      *
@@ -67,4 +138,170 @@ public:
     QString build_bom(const std::shared_ptr<Map>& map) const;
 
 private:
+    /**
+     * @brief      Whether a file uses the binary map format
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     True if binary, False otherwise.
+     */
+    static bool is_binary(const QString& filename);
+
+    /**
+     * @brief      Load map from a text (.htm) file
+     *
+     * @param[in]  filename  The filename
+     * @param      monitor   Optional progress monitor
+     *
+     * @return     shared pointer to map, nullptr if the load was cancelled
+     */
+    std::shared_ptr<Map> load_text(const QString& filename, LoadMonitor* monitor);
+
+    /**
+     * @brief      Add finished work to a progress monitor
+     *
+     * @param      monitor  The monitor, may be nullptr
+     * @param[in]  work     The amount of finished work
+     *
+     * @return     True if the load was cancelled, False otherwise.
+     */
+    static inline bool advance(LoadMonitor* monitor, size_t work) {
+        if(monitor == nullptr) {
+            return false;
+        }
+        monitor->work_done += work;
+        return monitor->cancelled;
+    }
+
+    /**
+     * @brief      Parse a block of complete lines of a text (.htm) file
+     *
+     * @param[in]  begin  Start of the block
+     * @param[in]  end    End of the block
+     * @param[out] block  The parsed tiles, or the line of the first error
+     */
+    void parse_block(const char* begin, const char* end, ParsedBlock* block) const;
+
+    /**
+     * @brief      Parse a single line of a text (.htm) file
+     *
+     * @param[in]  begin  Start of the line
+     * @param[in]  end    End of the line (excluding the newline)
+     * @param[out] tile   The parsed tile
+     *
+     * @return     True if a tile was parsed, False for a blank line.
+     */
+    bool parse_line(const char* begin, const char* end, Tile* tile) const;
+
+    /**
+     * @brief      Parse an integer with an optional leading plus sign
+     *
+     * @param[in]  token  The token
+     *
+     * @return     The integer
+     */
+    template <typename T>
+    static T parse_integer(std::string_view token) {
+        if(!token.empty() && token[0] == '+') {
+            token.remove_prefix(1);
+        }
+        T value = 0;
+        auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+        if(result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+            throw std::runtime_error("invalid number " + std::string(token));
+        }
+        return value;
+    }
+
+    /**
+     * @brief      Copy all tiles of a map in the order in which they are saved
+     *
+     * @param[in]  map   The map
+     *
+     * @return     The tiles
+     */
+    std::vector<Tile> take_snapshot(const std::shared_ptr<Map>& map) const;
+
+    /**
+     * @brief      Save tiles to filename, the format is deduced from the extension
+     *
+     * @param[in]  tiles     The tiles
+     * @param[in]  filename  The filename
+     */
+    void save_tiles(const std::vector<Tile>& tiles, const QString& filename) const;
+
+    /**
+     * @brief      Save tiles to a text (.htm) file
+     *
+     * @param[in]  tiles     The tiles
+     * @param[in]  filename  The filename
+     */
+    void save_text(const std::vector<Tile>& tiles, const QString& filename) const;
+
+    /**
+     * @brief      Write a coordinate as a sign followed by at least three digits
+     *
+     * @param      ptr    Output position
+     * @param[in]  value  The coordinate
+     *
+     * @return     Output position after the coordinate
+     */
+    static inline char* format_coordinate(char* ptr, int value) {
+        long long v = value;
+        *ptr++ = v < 0 ? '-' : '+';
+        if(v < 0) {
+            v = -v;
+        }
+        if(v < 100) {
+            *ptr++ = '0';
+        }
+        if(v < 10) {
+            *ptr++ = '0';
+        }
+        return std::to_chars(ptr, ptr + 20, v).ptr;
+    }
+
+    /**
+     * @brief      Load map from a binary (.htb) file
+     *
+     * @param[in]  filename  The filename
+     * @param      monitor   Optional progress monitor
+     *
+     * @return     shared pointer to map, nullptr if the load was cancelled
+     */
+    std::shared_ptr<Map> load_binary(const QString& filename, LoadMonitor* monitor);
+
+    /**
+     * @brief      Save tiles to a binary (.htb) file
+     *
+     * @param[in]  tiles     The tiles
+     * @param[in]  filename  The filename
+     */
+    void save_binary(const std::vector<Tile>& tiles, const QString& filename) const;
+
+    /**
+     * @brief      Write a buffer to a file that is only replaced once all data
+     *             has been written successfully
+     *
+     * @param      file    The file
+     * @param[in]  data    The data
+     * @param[in]  size    The size of the data
+     */
+    static void write_buffer(QSaveFile& file, const char* data, size_t size);
+
+    /**
+     * @brief      Read a little-endian 32-bit unsigned integer
+     */
+    static inline uint32_t read_uint32(const uchar* ptr) {
+        return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) | ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+    }
+
+    /**
+     * @brief      Append a little-endian 32-bit unsigned integer
+     */
+    static inline void write_uint32(std::vector<char>& buffer, uint32_t value) {
+        for(unsigned int i=0; i<4; i++) {
+            buffer.push_back((char)((value >> (8 * i)) & 0xFF));
+        }
+    }
 };
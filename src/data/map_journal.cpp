@@ -0,0 +1,190 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "map_journal.h"
+
+/**
+ * @brief      Constructs a new instance.
+ *
+ * @param[in]  capacity  Maximum number of edits that are stored
+ */
+MapJournal::MapJournal(size_t capacity) :
+    edits(std::max<size_t>(capacity, 1)) {
+
+}
+
+/**
+ * @brief      Start a transaction; transactions may be nested, in which
+ *             case the outermost transaction groups all edits
+ */
+void MapJournal::begin_transaction() {
+    if(this->depth++ == 0) {
+        this->open_begin = this->last;
+    }
+}
+
+/**
+ * @brief      Finish a transaction
+ */
+void MapJournal::end_transaction() {
+    if(this->depth == 0 || --this->depth > 0) {
+        return;
+    }
+
+    // a transaction that no longer fits in the buffer cannot be undone
+    if(this->open_begin < this->first) {
+        this->transactions.clear();
+        this->nr_applied = 0;
+        this->first = this->last;
+        return;
+    }
+
+    if(this->last > this->open_begin) {
+        this->transactions.push_back(Transaction{this->open_begin, this->last});
+        this->nr_applied = this->transactions.size();
+    }
+}
+
+/**
+ * @brief      Place, replace or remove a tile and record the modification
+ *
+ * @param      map      The map
+ * @param[in]  x        x coordinate
+ * @param[in]  y        y coordinate
+ * @param[in]  tile_id  The tile identifier, -1 to remove the tile
+ */
+void MapJournal::set_tile(Map& map, int x, int y, int tile_id) {
+    const int current = map.get_tile_id(x, y);
+    if(current == tile_id) {
+        return;
+    }
+
+    const MapEdit edit{x, y,
+                       (uint16_t)(current < 0 ? TILE_EMPTY : current),
+                       (uint16_t)(tile_id < 0 ? TILE_EMPTY : tile_id)};
+
+    // a modification outside of a transaction forms a transaction of its own
+    this->begin_transaction();
+    this->record(edit);
+    apply(map, x, y, edit.old_id, edit.new_id);
+    this->end_transaction();
+}
+
+/**
+ * @brief      Revert the most recent transaction
+ *
+ * @param      map   The map
+ *
+ * @return     True if a transaction was reverted, False otherwise.
+ */
+bool MapJournal::undo(Map& map) {
+    if(this->depth > 0 || !this->can_undo()) {
+        return false;
+    }
+
+    const Transaction& transaction = this->transactions[--this->nr_applied];
+    const size_t capacity = this->edits.size();
+    for(uint64_t n = transaction.end; n-- > transaction.begin; ) {
+        const MapEdit& edit = this->edits[n % capacity];
+        apply(map, edit.x, edit.y, edit.new_id, edit.old_id);
+    }
+    return true;
+}
+
+/**
+ * @brief      Reapply the most recently reverted transaction
+ *
+ * @param      map   The map
+ *
+ * @return     True if a transaction was reapplied, False otherwise.
+ */
+bool MapJournal::redo(Map& map) {
+    if(this->depth > 0 || !this->can_redo()) {
+        return false;
+    }
+
+    const Transaction& transaction = this->transactions[this->nr_applied++];
+    const size_t capacity = this->edits.size();
+    for(uint64_t n = transaction.begin; n < transaction.end; n++) {
+        const MapEdit& edit = this->edits[n % capacity];
+        apply(map, edit.x, edit.y, edit.old_id, edit.new_id);
+    }
+    return true;
+}
+
+/**
+ * @brief      Forget all transactions
+ */
+void MapJournal::clear() {
+    this->transactions.clear();
+    this->nr_applied = 0;
+    this->first = this->last;
+    this->open_begin = this->last;
+}
+
+/**
+ * @brief      Store an edit, discarding reverted transactions and the
+ *             oldest edits when the buffer is full
+ *
+ * @param[in]  edit  The edit
+ */
+void MapJournal::record(const MapEdit& edit) {
+    // a new modification invalidates the transactions that can be redone
+    if(this->can_redo()) {
+        this->last = this->transactions[this->nr_applied].begin;
+        this->transactions.resize(this->nr_applied);
+        if(this->open_begin > this->last) {
+            this->open_begin = this->last;
+        }
+    }
+
+    // overwrite the oldest edit and drop the transactions it belonged to
+    const size_t capacity = this->edits.size();
+    if(this->last - this->first == capacity) {
+        this->first++;
+        while(!this->transactions.empty() && this->transactions.front().begin < this->first) {
+            this->transactions.pop_front();
+            this->nr_applied--;
+        }
+    }
+
+    this->edits[this->last % capacity] = edit;
+    this->last++;
+}
+
+/**
+ * @brief      Change a cell of the map from one tile id to another
+ *
+ * @param      map   The map
+ * @param[in]  x     x coordinate
+ * @param[in]  y     y coordinate
+ * @param[in]  from  The current tile id, TILE_EMPTY for an empty cell
+ * @param[in]  to    The new tile id, TILE_EMPTY for an empty cell
+ */
+void MapJournal::apply(Map& map, int x, int y, uint16_t from, uint16_t to) {
+    if(to == TILE_EMPTY) {
+        map.remove_tile(x, y);
+    } else if(from == TILE_EMPTY) {
+        map.add_tile(to, x, y);
+    } else {
+        map.substitute_tile(to, x, y);
+    }
+}
@@ -0,0 +1,215 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "map.h"
+
+/**
+ * @brief      Change of a single cell; TILE_EMPTY denotes an empty cell
+ */
+struct MapEdit {
+    int32_t x, y;       // axial coordinates
+    uint16_t old_id;    // tile id before the change
+    uint16_t new_id;    // tile id after the change
+};
+
+/**
+ * @brief      Journal of the modifications made to a map, supporting undo and
+ *             redo
+ *
+ *             Every modification is stored as a compact delta in a ring
+ *             buffer of fixed capacity; the oldest modifications are dropped
+ *             once the buffer is full. Modifications are grouped into
+ *             transactions, which are undone and redone as a whole.
+ */
+class MapJournal {
+private:
+    /**
+     * @brief      Range [begin, end) of sequence numbers of the edits of a
+     *             transaction
+     */
+    struct Transaction {
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    std::vector<MapEdit> edits;             // ring buffer, edit n is stored at n % capacity
+    std::deque<Transaction> transactions;   // complete transactions, oldest first
+    size_t nr_applied = 0;                  // number of transactions that are not undone
+
+    uint64_t first = 0;                     // sequence number of the oldest stored edit
+    uint64_t last = 0;                      // sequence number after the newest edit
+
+    unsigned int depth = 0;                 // nesting depth of open transactions
+    uint64_t open_begin = 0;                // first edit of the open transaction
+
+public:
+    /**
+     * @brief      Constructs a new instance.
+     *
+     * @param[in]  capacity  Maximum number of edits that are stored
+     */
+    MapJournal(size_t capacity = 1 << 20);
+
+    /**
+     * @brief      Start a transaction; transactions may be nested, in which
+     *             case the outermost transaction groups all edits
+     */
+    void begin_transaction();
+
+    /**
+     * @brief      Finish a transaction
+     */
+    void end_transaction();
+
+    /**
+     * @brief      Place, replace or remove a tile and record the modification
+     *
+     * @param      map      The map
+     * @param[in]  x        x coordinate
+     * @param[in]  y        y coordinate
+     * @param[in]  tile_id  The tile identifier, -1 to remove the tile
+     */
+    void set_tile(Map& map, int x, int y, int tile_id);
+
+    /**
+     * @brief      Modify a set of cells as a single transaction
+     *
+     * @param      map        The map
+     * @param[in]  cells      The cells
+     * @param[in]  transform  Function accepting the current tile id of a
+     *                        cell (-1 if empty) and returning its new tile
+     *                        id (-1 to remove the tile)
+     */
+    template <typename Function>
+    void set_tiles(Map& map, const std::vector<AxialCoordinate>& cells, Function transform) {
+        this->begin_transaction();
+        for(const auto& cell : cells) {
+            const int current = map.get_tile_id(cell.first, cell.second);
+            const int tile_id = transform(current);
+            if(tile_id != current) {
+                this->set_tile(map, cell.first, cell.second, tile_id);
+            }
+        }
+        this->end_transaction();
+    }
+
+    /**
+     * @brief      Revert the most recent transaction
+     *
+     * @param      map   The map
+     *
+     * @return     True if a transaction was reverted, False otherwise.
+     */
+    bool undo(Map& map);
+
+    /**
+     * @brief      Reapply the most recently reverted transaction
+     *
+     * @param      map   The map
+     *
+     * @return     True if a transaction was reapplied, False otherwise.
+     */
+    bool redo(Map& map);
+
+    /**
+     * @brief      Visit the changes that undo would make, without making them
+     *
+     * @param[in]  f     Function accepting the tile id of a cell before and
+     *                   after the change (-1 if empty)
+     */
+    template <typename Function>
+    void for_each_undo_change(Function f) const {
+        if(this->depth > 0 || !this->can_undo()) {
+            return;
+        }
+        const Transaction& transaction = this->transactions[this->nr_applied - 1];
+        for(uint64_t n = transaction.begin; n < transaction.end; n++) {
+            const MapEdit& edit = this->edits[n % this->edits.size()];
+            f(to_tile_id(edit.new_id), to_tile_id(edit.old_id));
+        }
+    }
+
+    /**
+     * @brief      Visit the changes that redo would make, without making them
+     *
+     * @param[in]  f     Function accepting the tile id of a cell before and
+     *                   after the change (-1 if empty)
+     */
+    template <typename Function>
+    void for_each_redo_change(Function f) const {
+        if(this->depth > 0 || !this->can_redo()) {
+            return;
+        }
+        const Transaction& transaction = this->transactions[this->nr_applied];
+        for(uint64_t n = transaction.begin; n < transaction.end; n++) {
+            const MapEdit& edit = this->edits[n % this->edits.size()];
+            f(to_tile_id(edit.old_id), to_tile_id(edit.new_id));
+        }
+    }
+
+    inline bool can_undo() const {
+        return this->nr_applied > 0;
+    }
+
+    inline bool can_redo() const {
+        return this->nr_applied < this->transactions.size();
+    }
+
+    /**
+     * @brief      Forget all transactions
+     */
+    void clear();
+
+private:
+    /**
+     * @brief      Store an edit, discarding reverted transactions and the
+     *             oldest edits when the buffer is full
+     *
+     * @param[in]  edit  The edit
+     */
+    void record(const MapEdit& edit);
+
+    /**
+     * @brief      Change a cell of the map from one tile id to another
+     *
+     * @param      map   The map
+     * @param[in]  x     x coordinate
+     * @param[in]  y     y coordinate
+     * @param[in]  from  The current tile id, TILE_EMPTY for an empty cell
+     * @param[in]  to    The new tile id, TILE_EMPTY for an empty cell
+     */
+    static void apply(Map& map, int x, int y, uint16_t from, uint16_t to);
+
+    /**
+     * @brief      Convert a stored tile id to a tile id, -1 for an empty cell
+     */
+    static inline int to_tile_id(uint16_t id) {
+        return id == TILE_EMPTY ? -1 : id;
+    }
+};
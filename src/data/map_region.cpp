@@ -0,0 +1,108 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "map_region.h"
+
+const int MapRegion::neighbours[6][2] = {
+    {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, -1}, {-1, 1}
+};
+
+/**
+ * @brief      Get all cells within a hexagonal distance of a cell
+ *
+ * @param[in]  x       x coordinate of the center
+ * @param[in]  y       y coordinate of the center
+ * @param[in]  radius  The radius, 0 yields only the center
+ *
+ * @return     The cells
+ */
+std::vector<AxialCoordinate> MapRegion::hexagon(int x, int y, unsigned int radius) {
+    const int r = radius;
+    std::vector<AxialCoordinate> cells;
+    cells.reserve(3 * r * (r + 1) + 1);
+
+    for(int dx = -r; dx <= r; dx++) {
+        const int dymin = std::max(-r, -dx - r);
+        const int dymax = std::min(r, -dx + r);
+        for(int dy = dymin; dy <= dymax; dy++) {
+            cells.emplace_back(x + dx, y + dy);
+        }
+    }
+
+    return cells;
+}
+
+/**
+ * @brief      Get all cells within the screen aligned rectangle spanned
+ *             by two corner cells, covering the columns (x) and screen
+ *             rows (2y + x) between the corners
+ *
+ * @param[in]  x1    x coordinate of the first corner
+ * @param[in]  y1    y coordinate of the first corner
+ * @param[in]  x2    x coordinate of the second corner
+ * @param[in]  y2    y coordinate of the second corner
+ *
+ * @return     The cells
+ */
+std::vector<AxialCoordinate> MapRegion::rectangle(int x1, int y1, int x2, int y2) {
+    const int xmin = std::min(x1, x2);
+    const int xmax = std::max(x1, x2);
+    const int rowmin = std::min(2 * y1 + x1, 2 * y2 + x2);
+    const int rowmax = std::max(2 * y1 + x1, 2 * y2 + x2);
+
+    std::vector<AxialCoordinate> cells;
+    cells.reserve((size_t)(xmax - xmin + 1) * ((rowmax - rowmin) / 2 + 1));
+
+    for(int x = xmin; x <= xmax; x++) {
+        // rows of a column differ by two, ceil and floor of (row - x) / 2
+        const int ymin = (rowmin - x + 1) >> 1;
+        const int ymax = (rowmax - x) >> 1;
+        for(int y = ymin; y <= ymax; y++) {
+            cells.emplace_back(x, y);
+        }
+    }
+
+    return cells;
+}
+
+/**
+ * @brief      Count the tiles on a set of cells per tile id
+ *
+ * @param[in]  map    The map
+ * @param[in]  cells  The cells
+ *
+ * @return     The numbers of tiles indexed by tile id, in the same layout
+ *             as Map::get_tile_counts
+ */
+std::vector<size_t> MapRegion::count_tiles(const Map& map, const std::vector<AxialCoordinate>& cells) {
+    std::vector<size_t> counts;
+    for(const auto& cell : cells) {
+        const int tile_id = map.get_tile_id(cell.first, cell.second);
+        if(tile_id < 0) {
+            continue;
+        }
+        if((size_t)tile_id >= counts.size()) {
+            counts.resize(tile_id + 1, 0);
+        }
+        counts[tile_id]++;
+    }
+    return counts;
+}
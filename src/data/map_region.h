@@ -0,0 +1,124 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <unordered_set>
+#include <cstddef>
+
+#include "map.h"
+
+/**
+ * @brief      Sets of cells on which a modification of the map is performed
+ *             as a whole
+ */
+class MapRegion {
+private:
+    static const int neighbours[6][2];      // axial offsets of the adjacent cells
+
+public:
+    /**
+     * @brief      Get all cells within a hexagonal distance of a cell
+     *
+     * @param[in]  x       x coordinate of the center
+     * @param[in]  y       y coordinate of the center
+     * @param[in]  radius  The radius, 0 yields only the center
+     *
+     * @return     The cells
+     */
+    static std::vector<AxialCoordinate> hexagon(int x, int y, unsigned int radius);
+
+    /**
+     * @brief      Get all cells within the screen aligned rectangle spanned
+     *             by two corner cells, covering the columns (x) and screen
+     *             rows (2y + x) between the corners
+     *
+     * @param[in]  x1    x coordinate of the first corner
+     * @param[in]  y1    y coordinate of the first corner
+     * @param[in]  x2    x coordinate of the second corner
+     * @param[in]  y2    y coordinate of the second corner
+     *
+     * @return     The cells
+     */
+    static std::vector<AxialCoordinate> rectangle(int x1, int y1, int x2, int y2);
+
+    /**
+     * @brief      Count the tiles on a set of cells per tile id
+     *
+     * @param[in]  map    The map
+     * @param[in]  cells  The cells
+     *
+     * @return     The numbers of tiles indexed by tile id, in the same layout
+     *             as Map::get_tile_counts
+     */
+    static std::vector<size_t> count_tiles(const Map& map, const std::vector<AxialCoordinate>& cells);
+
+    /**
+     * @brief      Get the connected cells with a tile matching a predicate,
+     *             starting from a cell
+     *
+     * @param[in]  map        The map
+     * @param[in]  x          x coordinate of the starting cell
+     * @param[in]  y          y coordinate of the starting cell
+     * @param[in]  connects   Function accepting a tile id (-1 for an empty
+     *                        cell) that returns whether the fill spreads
+     *                        into a cell holding it
+     * @param[in]  max_cells  Maximum number of cells that is collected
+     * @param[out] truncated  Whether the region holds more than max_cells
+     *                        cells, of which only max_cells are returned
+     *
+     * @return     The cells, empty if the starting cell does not match
+     */
+    template <typename Predicate>
+    static std::vector<AxialCoordinate> flood_fill(const Map& map, int x, int y,
+                                                   Predicate connects, size_t max_cells,
+                                                   bool* truncated) {
+        std::vector<AxialCoordinate> cells;
+        *truncated = false;
+        if(!connects(map.get_tile_id(x, y))) {
+            return cells;
+        }
+
+        std::unordered_set<AxialCoordinate, HashAxialCoordinate> visited;
+        std::deque<AxialCoordinate> queue;
+        visited.emplace(x, y);
+        queue.emplace_back(x, y);
+
+        while(!queue.empty() && cells.size() < max_cells) {
+            const AxialCoordinate cell = queue.front();
+            queue.pop_front();
+            cells.push_back(cell);
+
+            for(const auto& d : neighbours) {
+                const AxialCoordinate next(cell.first + d[0], cell.second + d[1]);
+                if(visited.insert(next).second && connects(map.get_tile_id(next.first, next.second))) {
+                    queue.push_back(next);
+                }
+            }
+        }
+
+        // cells that are still queued were reached but not collected
+        *truncated = !queue.empty();
+        return cells;
+    }
+};
@@ -0,0 +1,172 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "png_writer.h"
+
+/**
+ * @brief      Write a 32-bit big-endian integer
+ */
+static void write_uint32_be(char* out, uint32_t value) {
+    out[0] = (char)(value >> 24);
+    out[1] = (char)(value >> 16);
+    out[2] = (char)(value >> 8);
+    out[3] = (char)value;
+}
+
+/**
+ * @brief      Constructs a new instance and writes the image header
+ *
+ * @param[in]  filename  The filename
+ * @param[in]  _width    The width in pixels
+ * @param[in]  _height   The height in pixels
+ */
+PngWriter::PngWriter(const QString& filename, unsigned int _width, unsigned int _height) :
+    outfile(filename),
+    width(_width),
+    height(_height) {
+
+    if(width == 0 || height == 0 || width > 0x7FFFFFFF / 4 || height > 0x7FFFFFFF) {
+        throw std::runtime_error("Invalid image dimensions for PNG file: " + filename.toStdString());
+    }
+    if(!this->outfile.open(QIODevice::WriteOnly)) {
+        throw std::runtime_error("Could not open file for writing: " + filename.toStdString());
+    }
+
+    static const char signature[8] = {'\x89', 'P', 'N', 'G', '\r', '\n', '\x1a', '\n'};
+    this->outfile.write(signature, 8);
+
+    // 8-bit RGBA, deflate compression, adaptive filtering, no interlacing
+    char header[13];
+    write_uint32_be(header, this->width);
+    write_uint32_be(header + 4, this->height);
+    header[8] = 8;
+    header[9] = 6;
+    header[10] = 0;
+    header[11] = 0;
+    header[12] = 0;
+    this->write_chunk("IHDR", header, 13);
+
+    this->chunk.reserve(chunk_size);
+    this->filtered.resize(1 + (size_t)this->width * 4);
+    this->deflater = std::make_unique<boost::iostreams::filtering_ostream>();
+    this->deflater->push(boost::iostreams::zlib_compressor(boost::iostreams::zlib::default_compression, chunk_size));
+    this->deflater->push(IdatSink(this));
+}
+
+/**
+ * @brief      Destroys the object; an unfinished image is discarded
+ */
+PngWriter::~PngWriter() {
+    // the sink refers to this object, hence the stream is closed first
+    this->deflater.reset();
+}
+
+/**
+ * @brief      Append the next row of the image, rows are written top to bottom
+ *
+ * @param[in]  rgba  Pixel data of the row, four bytes per pixel
+ */
+void PngWriter::write_row(const uint8_t* rgba) {
+    if(this->rows_written == this->height) {
+        throw std::runtime_error("Too many rows written to PNG file");
+    }
+
+    // the 'sub' filter stores the difference with the pixel to the left,
+    // which compresses large areas of uniform color well
+    this->filtered[0] = 1;
+    const size_t row_bytes = (size_t)this->width * 4;
+    for(size_t i=0; i<4 && i<row_bytes; i++) {
+        this->filtered[1 + i] = rgba[i];
+    }
+    for(size_t i=4; i<row_bytes; i++) {
+        this->filtered[1 + i] = (uint8_t)(rgba[i] - rgba[i - 4]);
+    }
+
+    this->deflater->write((const char*)&this->filtered[0], this->filtered.size());
+    this->rows_written++;
+}
+
+/**
+ * @brief      Complete the image after all rows are written and move it
+ *             to its destination
+ */
+void PngWriter::finish() {
+    if(this->rows_written != this->height) {
+        throw std::runtime_error("Incomplete PNG image");
+    }
+
+    // flush the remaining compressed data
+    this->deflater.reset();
+    if(!this->chunk.empty()) {
+        this->write_chunk("IDAT", &this->chunk[0], this->chunk.size());
+        this->chunk.clear();
+    }
+
+    // the temporary file only replaces the destination when all writes succeeded
+    this->write_chunk("IEND", nullptr, 0);
+    if(!this->outfile.commit()) {
+        throw std::runtime_error("Could not write PNG file: " + this->outfile.errorString().toStdString());
+    }
+}
+
+/**
+ * @brief      Add deflated data, writing IDAT chunks when full
+ *
+ * @param[in]  data  The data
+ * @param[in]  n     The number of bytes
+ */
+void PngWriter::append_compressed(const char* data, std::streamsize n) {
+    while(n > 0) {
+        const size_t count = std::min<size_t>(n, chunk_size - this->chunk.size());
+        this->chunk.insert(this->chunk.end(), data, data + count);
+        data += count;
+        n -= count;
+
+        if(this->chunk.size() == chunk_size) {
+            this->write_chunk("IDAT", &this->chunk[0], this->chunk.size());
+            this->chunk.clear();
+        }
+    }
+}
+
+/**
+ * @brief      Write a chunk of the PNG file
+ *
+ * @param[in]  type  The chunk type
+ * @param[in]  data  The chunk data
+ * @param[in]  size  The size of the chunk data
+ */
+void PngWriter::write_chunk(const char* type, const char* data, size_t size) {
+    char buffer[4];
+    write_uint32_be(buffer, size);
+    this->outfile.write(buffer, 4);
+    this->outfile.write(type, 4);
+    if(size > 0) {
+        this->outfile.write(data, size);
+    }
+
+    // the checksum covers the chunk type and data
+    boost::crc_32_type crc;
+    crc.process_bytes(type, 4);
+    crc.process_bytes(data, size);
+    write_uint32_be(buffer, crc.checksum());
+    this->outfile.write(buffer, 4);
+}
@@ -0,0 +1,119 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QSaveFile>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/concepts.hpp>
+#include <boost/crc.hpp>
+
+/**
+ * @brief      Writes an 8-bit RGBA PNG image row by row, such that images
+ *             that do not fit in memory can be written; rows are deflated
+ *             as they arrive and emitted in IDAT chunks of a fixed size;
+ *             the image is written to a temporary file that only replaces
+ *             the destination once it is finished
+ */
+class PngWriter {
+private:
+    QSaveFile outfile;
+    unsigned int width;
+    unsigned int height;
+    unsigned int rows_written = 0;
+
+    std::vector<char> chunk;                // pending compressed data of the next IDAT chunk
+    std::vector<uint8_t> filtered;          // row with filter byte
+    std::unique_ptr<boost::iostreams::filtering_ostream> deflater;
+
+    static constexpr size_t chunk_size = 1 << 16;
+
+    /**
+     * @brief      Sink that collects the deflated data into IDAT chunks
+     */
+    class IdatSink : public boost::iostreams::sink {
+    private:
+        PngWriter* writer;
+
+    public:
+        IdatSink(PngWriter* _writer) : writer(_writer) {}
+
+        std::streamsize write(const char* data, std::streamsize n) {
+            this->writer->append_compressed(data, n);
+            return n;
+        }
+    };
+
+public:
+    /**
+     * @brief      Constructs a new instance and writes the image header
+     *
+     * @param[in]  filename  The filename
+     * @param[in]  _width    The width in pixels
+     * @param[in]  _height   The height in pixels
+     */
+    PngWriter(const QString& filename, unsigned int _width, unsigned int _height);
+
+    /**
+     * @brief      Destroys the object; an unfinished image is discarded
+     */
+    ~PngWriter();
+
+    /**
+     * @brief      Append the next row of the image, rows are written top to bottom
+     *
+     * @param[in]  rgba  Pixel data of the row, four bytes per pixel
+     */
+    void write_row(const uint8_t* rgba);
+
+    /**
+     * @brief      Complete the image after all rows are written and move it
+     *             to its destination
+     */
+    void finish();
+
+private:
+    /**
+     * @brief      Add deflated data, writing IDAT chunks when full
+     *
+     * @param[in]  data  The data
+     * @param[in]  n     The number of bytes
+     */
+    void append_compressed(const char* data, std::streamsize n);
+
+    /**
+     * @brief      Write a chunk of the PNG file
+     *
+     * @param[in]  type  The chunk type
+     * @param[in]  data  The chunk data
+     * @param[in]  size  The size of the chunk data
+     */
+    void write_chunk(const char* type, const char* data, size_t size);
+};
@@ -0,0 +1,188 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "stamp_library.h"
+
+/**
+ * @brief      Constructs a new instance.
+ *
+ * @param[in]  _tile_manager  The tile manager
+ */
+StampLibrary::StampLibrary(const std::shared_ptr<TileManager>& _tile_manager) :
+    tile_manager(_tile_manager) {
+
+}
+
+/**
+ * @brief      Store a fragment under a name, replacing any stamp with the
+ *             same name
+ *
+ * @param[in]  name      The name
+ * @param[in]  fragment  The fragment
+ */
+void StampLibrary::add(const std::string& name, const std::shared_ptr<const MapFragment>& fragment) {
+    if(name.empty() || name.find('\n') != std::string::npos) {
+        throw std::runtime_error("Invalid stamp name: " + name);
+    }
+
+    this->stamps[name] = fragment;
+}
+
+/**
+ * @brief      Remove a stamp
+ *
+ * @param[in]  name  The name
+ */
+void StampLibrary::remove(const std::string& name) {
+    this->stamps.erase(name);
+}
+
+/**
+ * @brief      Get a stamp
+ *
+ * @param[in]  name  The name
+ *
+ * @return     The fragment, nullptr if there is no stamp with that name
+ */
+std::shared_ptr<const MapFragment> StampLibrary::get(const std::string& name) const {
+    auto got = this->stamps.find(name);
+    return got != this->stamps.end() ? got->second : nullptr;
+}
+
+/**
+ * @brief      Get the names of all stamps in alphabetical order
+ *
+ * @return     The names
+ */
+std::vector<std::string> StampLibrary::get_names() const {
+    std::vector<std::string> names;
+    names.reserve(this->stamps.size());
+    for(const auto& stamp : this->stamps) {
+        names.push_back(stamp.first);
+    }
+    return names;
+}
+
+/**
+ * @brief      Load stamps from a file, adding them to the library
+ *
+ * @param[in]  filename  The filename
+ */
+void StampLibrary::load(const QString& filename) {
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Could not open file for reading: " + filename.toStdString());
+    }
+
+    // stamps are only added once the complete file has been parsed
+    std::vector<std::pair<std::string, std::shared_ptr<const MapFragment>>> loaded;
+    while(!file.atEnd()) {
+        const QByteArray header = file.readLine().trimmed();
+        if(header.isEmpty()) {
+            continue;
+        }
+
+        const QList<QByteArray> fields = header.split(' ');
+        if(fields.size() < 3 || fields[0] != "stamp") {
+            throw std::runtime_error("Expected a stamp header in " + filename.toStdString());
+        }
+        const int nr_tiles = parse_integer(fields[1]);
+        const std::string name = header.mid(fields[0].size() + fields[1].size() + 2).trimmed().toStdString();
+
+        std::vector<FragmentTile> tiles;
+        tiles.reserve(std::max(nr_tiles, 0));
+        for(int i=0; i<nr_tiles; i++) {
+            const QList<QByteArray> line = file.readLine().simplified().split(' ');
+            if(line.size() != 5) {
+                throw std::runtime_error("Expected 5 fields for a tile of stamp " + name);
+            }
+
+            const int dx = parse_integer(line[2]);
+            const int dy = parse_integer(line[3]);
+            const int dz = parse_integer(line[4]);
+            if(dx + dy + dz != 0) {
+                throw std::runtime_error("Invalid cubic coordinate in stamp " + name);
+            }
+            if(std::max({dx, dy, dz}) > std::numeric_limits<int16_t>::max() ||
+               std::min({dx, dy, dz}) < -std::numeric_limits<int16_t>::max()) {
+                throw std::runtime_error("Stamp " + name + " exceeds the maximum extent");
+            }
+
+            const int tile_id = this->tile_manager->get_tile_id(line[0].toStdString(), parse_integer(line[1]));
+            if(tile_id < 0) {
+                throw std::runtime_error("Unknown tile " + line[0].toStdString() + " " + line[1].toStdString() + " in stamp " + name);
+            }
+            tiles.push_back(FragmentTile{(int16_t)dx, (int16_t)dy, (uint16_t)tile_id});
+        }
+
+        loaded.emplace_back(name, std::make_shared<const MapFragment>(std::move(tiles)));
+    }
+
+    for(const auto& stamp : loaded) {
+        this->add(stamp.first, stamp.second);
+    }
+}
+
+/**
+ * @brief      Save all stamps to a file
+ *
+ * @param[in]  filename  The filename
+ */
+void StampLibrary::save(const QString& filename) const {
+    QSaveFile file(filename);
+    if(!file.open(QIODevice::WriteOnly)) {
+        throw std::runtime_error("Could not open file for writing: " + filename.toStdString());
+    }
+
+    QByteArray data;
+    for(const auto& stamp : this->stamps) {
+        const auto& tiles = stamp.second->get_tiles();
+        data += "stamp " + QByteArray::number((int)tiles.size()) + " " + QByteArray::fromStdString(stamp.first) + "\n";
+        for(const FragmentTile& tile : tiles) {
+            const unsigned int angle = this->tile_manager->rotation_of(tile.tile_id) * 60;
+            data += QByteArray::fromStdString(this->tile_manager->get_base_code(this->tile_manager->base_of(tile.tile_id)));
+            data += " " + QByteArray::number(angle).rightJustified(3, '0');
+            data += " " + QByteArray::number(tile.dx);
+            data += " " + QByteArray::number(tile.dy);
+            data += " " + QByteArray::number(-tile.dx - tile.dy) + "\n";
+        }
+    }
+
+    if(file.write(data) != data.size() || !file.commit()) {
+        throw std::runtime_error("Could not write file: " + filename.toStdString());
+    }
+}
+
+/**
+ * @brief      Parse an integer field of a stamp file
+ *
+ * @param[in]  field  The field
+ *
+ * @return     The integer
+ */
+int StampLibrary::parse_integer(const QByteArray& field) {
+    bool ok = false;
+    const int value = field.toInt(&ok);
+    if(!ok) {
+        throw std::runtime_error("Invalid number in stamp file: " + field.toStdString());
+    }
+    return value;
+}
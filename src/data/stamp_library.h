@@ -0,0 +1,114 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QFile>
+#include <QSaveFile>
+#include <QByteArray>
+#include <QList>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "map_fragment.h"
+#include "tile_manager.h"
+
+/*
+ * Stamp library format (.hts), a text file holding the stamps in sequence
+ *
+ *   header   stamp <number of tiles> <name>
+ *   tiles    per tile: <tile code> <angle> <dx> <dy> <dz>, as in a map (.htm)
+ *            file with the cubic offsets relative to the anchor of the stamp
+ */
+class StampLibrary {
+private:
+    std::shared_ptr<TileManager> tile_manager;
+    std::map<std::string, std::shared_ptr<const MapFragment>> stamps;  // sorted by name
+
+public:
+    /**
+     * @brief      Constructs a new instance.
+     *
+     * @param[in]  _tile_manager  The tile manager
+     */
+    StampLibrary(const std::shared_ptr<TileManager>& _tile_manager);
+
+    /**
+     * @brief      Store a fragment under a name, replacing any stamp with the
+     *             same name
+     *
+     * @param[in]  name      The name
+     * @param[in]  fragment  The fragment
+     */
+    void add(const std::string& name, const std::shared_ptr<const MapFragment>& fragment);
+
+    /**
+     * @brief      Remove a stamp
+     *
+     * @param[in]  name  The name
+     */
+    void remove(const std::string& name);
+
+    /**
+     * @brief      Get a stamp
+     *
+     * @param[in]  name  The name
+     *
+     * @return     The fragment, nullptr if there is no stamp with that name
+     */
+    std::shared_ptr<const MapFragment> get(const std::string& name) const;
+
+    /**
+     * @brief      Get the names of all stamps in alphabetical order
+     *
+     * @return     The names
+     */
+    std::vector<std::string> get_names() const;
+
+    /**
+     * @brief      Load stamps from a file, adding them to the library
+     *
+     * @param[in]  filename  The filename
+     */
+    void load(const QString& filename);
+
+    /**
+     * @brief      Save all stamps to a file
+     *
+     * @param[in]  filename  The filename
+     */
+    void save(const QString& filename) const;
+
+private:
+    /**
+     * @brief      Parse an integer field of a stamp file
+     *
+     * @param[in]  field  The field
+     *
+     * @return     The integer
+     */
+    static int parse_integer(const QByteArray& field);
+};
@@ -21,10 +21,9 @@
 
 #include "tile.h"
 
-Tile::Tile(unsigned int _tile_id, int _x, int _y, int _z) :
-    tile_id(_tile_id),
+Tile::Tile(unsigned int _tile_id, int _x, int _y) :
     x(_x),
     y(_y),
-    z(_z) {
+    tile_id(_tile_id) {
 
 }
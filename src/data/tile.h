@@ -21,13 +21,30 @@
 
 #pragma once
 
+#include <cstdint>
+
+// tile id marking an empty cell; the tile catalogue holds fewer tiles than this
+constexpr uint16_t TILE_EMPTY = 0xFFFF;
+
+/**
+ * @brief      Packed tile record; the rotation of a tile is part of its tile
+ *             id and the third cubic coordinate is derived from the other two
+ */
 class Tile {
 public:
-    Tile(unsigned int tilename, int _x, int _y, int _z);
+    Tile(unsigned int _tile_id, int _x, int _y);
+
+    int x,y;                // axial grid coordinates
+    uint16_t tile_id;       // tile_id, including rotation
 
-    unsigned int tile_id;   // tile_id
-    int x,y,z;              // cubic grid coordinates
-    unsigned int angle;     // rotational angle
+    /**
+     * @brief      Get the third cubic grid coordinate
+     *
+     * @return     z coordinate
+     */
+    inline int z() const {
+        return -(this->x + this->y);
+    }
 
 private:
 };
@@ -20,36 +20,119 @@
  **************************************************************************/
 
 #include "tile_manager.h"
+#include "tile.h"
 
-TileManager::TileManager() {
+// catalogue generated from tiledata.json at build time, see hextontiler.pro;
+// only included here such that other sources do not depend on it
+#ifdef USE_GENERATED_TILE_CATALOGUE
+#include "tile_catalogue.h"
+#endif
+
+/**
+ * @brief      Constructs a new instance.
+ *
+ * @param[in]  catalogue  Optional tile catalogue (.json) of a custom tile
+ *                        pack; when empty, the built-in catalogue is used
+ */
+TileManager::TileManager(const QString& catalogue) {
     try {
-        boost::property_tree::ptree root;
-        QTemporaryDir tmp_dir;
-        QFile::copy(":/assets/configuration/tiledata.json", tmp_dir.path() + "/tiledata.json");
-        boost::property_tree::read_json(tmp_dir.path().toStdString() + "/tiledata.json", root);
-
-        for(auto iter = root.begin(); iter != root.end(); iter++) {
-            std::string name = iter->first;
-            float uvx1 = root.get<double>(iter->first + ".uvx1");
-            float uvx2 = root.get<double>(iter->first + ".uvx2");
-            float uvy1 = root.get<double>(iter->first + ".uvy1");
-            float uvy2 = root.get<double>(iter->first + ".uvy2");
-
-            QVector4D uv(uvx1, uvy1, uvx2, uvy2);
-            this->tile_ids.emplace(name, this->tilenames.size());
-            this->tilenames.push_back(name);
-            this->uvs.push_back(uv);
-            this->colors.push_back(this->get_color_from_tilecode(iter->first.substr(0,2)));
+        if(!catalogue.isEmpty()) {
+            this->load_catalogue(catalogue);
+        } else {
+#ifdef USE_GENERATED_TILE_CATALOGUE
+            this->load_generated_catalogue();
+#else
+            this->load_catalogue(":/assets/configuration/tiledata.json");
+#endif
+        }
+
+        // tile ids are stored as 16-bit integers in the map
+        if(this->tilenames.size() >= TILE_EMPTY) {
+            throw std::runtime_error("Too many tiles in the tile catalogue");
         }
 
     } catch(std::exception const& ex) {
-        std::cerr << "[ERROR] There was an error parsing the JSON tree" << std::endl;
+        std::cerr << "[ERROR] There was an error loading the tile catalogue" << std::endl;
         std::cerr << ex.what() << std::endl;
         std::cerr << "[ERROR] Terminating program" << std::endl;
         exit(-1);
     }
 }
 
+/**
+ * @brief      Load the tile catalogue from a json file
+ *
+ * @param[in]  filename  The filename
+ */
+void TileManager::load_catalogue(const QString& filename) {
+    // the catalogue is parsed directly from the file data
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Could not open tile catalogue: " + filename.toStdString());
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+
+    JsonReader reader(data.constData(), data.constData() + data.size());
+    reader.begin_object();
+    std::string_view tilename;
+    while(reader.next_member(&tilename)) {
+        std::string name(tilename);
+
+        // read the texture coordinates of the tile in the atlas
+        float uv[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        unsigned int found = 0;
+        std::string_view key;
+        reader.begin_object();
+        while(reader.next_member(&key)) {
+            static const std::string_view keys[4] = {"uvx1", "uvy1", "uvx2", "uvy2"};
+            const auto got = std::find(keys, keys + 4, key);
+            if(got != keys + 4) {
+                uv[got - keys] = reader.read_number();
+                found |= 1 << (got - keys);
+            } else {
+                reader.skip_value();
+            }
+        }
+        if(found != 0xF) {
+            throw std::runtime_error("Missing texture coordinates for tile " + name);
+        }
+
+        this->add_tile(name, QVector4D(uv[0], uv[1], uv[2], uv[3]));
+    }
+    reader.finish();
+}
+
+#ifdef USE_GENERATED_TILE_CATALOGUE
+/**
+ * @brief      Load the tile catalogue that was generated at build time
+ */
+void TileManager::load_generated_catalogue() {
+    this->tilenames.reserve(tile_catalogue::size);
+    this->uvs.reserve(tile_catalogue::size);
+    this->colors.reserve(tile_catalogue::size);
+
+    for(size_t i=0; i<tile_catalogue::size; i++) {
+        const float* uv = tile_catalogue::uvs[i];
+        this->add_tile(tile_catalogue::names[i], QVector4D(uv[0], uv[1], uv[2], uv[3]));
+    }
+}
+#endif
+
+/**
+ * @brief      Add a tile to the catalogue
+ *
+ * @param[in]  name  The tile name
+ * @param[in]  uv    The texture coordinates in the atlas
+ */
+void TileManager::add_tile(const std::string& name, const QVector4D& uv) {
+    this->tile_ids.emplace(name, this->tilenames.size());
+    this->tilenames.push_back(name);
+    this->uvs.push_back(uv);
+    this->colors.push_back(this->get_color_from_tilecode(name.substr(0,2)));
+    this->add_variant(name, this->tilenames.size() - 1);
+}
+
 /**
  * @brief      Gets the tile identifier.
  *
@@ -64,6 +147,84 @@ unsigned int TileManager::get_tile_id(const std::string& tile_id) const {
     }
 }
 
+/**
+ * @brief      Rotate a tile by a number of 60 degree steps (counter-clockwise
+ *             for positive steps); rotations that do not exist in the
+ *             catalogue are skipped
+ *
+ * @param[in]  tile_id  The tile identifier
+ * @param[in]  steps    The number of steps
+ *
+ * @return     The tile identifier of the rotated tile
+ */
+unsigned int TileManager::rotate(unsigned int tile_id, int steps) const {
+    const unsigned int base_id = this->tile_bases[tile_id];
+    const int direction = steps < 0 ? -1 : 1;
+    int rotation = this->tile_rotations[tile_id] + steps;
+
+    // at most a full turn is needed, as the tile itself is always present
+    for(int i=0; i<TILE_ROTATIONS; i++, rotation += direction) {
+        const int variant = this->get_variant(base_id, ((rotation % TILE_ROTATIONS) + TILE_ROTATIONS) % TILE_ROTATIONS);
+        if(variant >= 0) {
+            return variant;
+        }
+    }
+
+    return tile_id;
+}
+
+/**
+ * @brief      Sum numbers of tiles per tile id into numbers per base tile,
+ *             i.e. irrespective of rotation
+ *
+ * @param[in]  tile_counts  The numbers of tiles indexed by tile id
+ *
+ * @return     The numbers of tiles indexed by base id
+ */
+std::vector<size_t> TileManager::count_bases(const std::vector<size_t>& tile_counts) const {
+    std::vector<size_t> counts(this->get_nr_bases(), 0);
+    const size_t nr_tiles = std::min(tile_counts.size(), this->tile_bases.size());
+    for(size_t i=0; i<nr_tiles; i++) {
+        counts[this->tile_bases[i]] += tile_counts[i];
+    }
+    return counts;
+}
+
+/**
+ * @brief      Register a tile as a rotation of a base tile
+ *
+ * @param[in]  name     The tile name
+ * @param[in]  tile_id  The tile identifier
+ */
+void TileManager::add_variant(const std::string& name, unsigned int tile_id) {
+    // tile names are composed of a four-character code and a three-digit
+    // angle; any other tile forms a base tile of its own
+    std::string code = name;
+    unsigned int rotation = 0;
+    unsigned int angle = 0;
+    if(name.size() == 8 && name[4] == '_' &&
+       std::from_chars(name.data() + 5, name.data() + 8, angle).ptr == name.data() + 8) {
+        if(angle % 60 == 0 && angle < 360) {
+            code = name.substr(0,4);
+            rotation = angle / 60;
+        }
+    }
+
+    unsigned int base_id = this->base_codes.size();
+    if(code.size() == 4) {
+        auto got = this->base_ids.emplace(pack_code(code), base_id);
+        base_id = got.first->second;
+    }
+    if(base_id == this->base_codes.size()) {
+        this->base_codes.push_back(code);
+        this->variants.resize(this->variants.size() + TILE_ROTATIONS, -1);
+    }
+
+    this->variants[base_id * TILE_ROTATIONS + rotation] = tile_id;
+    this->tile_bases.push_back(base_id);
+    this->tile_rotations.push_back(rotation);
+}
+
 QVector3D TileManager::get_color_from_tilecode(const std::string& tile_id) const {
     if(tile_id == "AS") { // settlements
         return QVector3D(0.477, 0.352, 0.262);
@@ -22,31 +22,47 @@
 #pragma once
 
 #include <QFile>
-#include <QTemporaryDir>
+#include <QByteArray>
 #include <QVector4D>
 #include <QVector3D>
 
 #include <unordered_map>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <iostream>
 #include <exception>
+#include <charconv>
+#include <algorithm>
 
-// boost headers
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/foreach.hpp>
-#include <boost/lexical_cast.hpp>
+#include "json_reader.h"
+
+// number of rotations of a tile in steps of 60 degrees
+constexpr int TILE_ROTATIONS = 6;
 
 class TileManager {
 private:
     std::unordered_map<std::string, unsigned int> tile_ids;
     std::vector<std::string> tilenames;
+
+    // every tile is a rotation of a base tile, e.g. AF01_060 is AF01 rotated once
+    std::unordered_map<uint32_t, unsigned int> base_ids;    // packed tile code -> base id
+    std::vector<std::string> base_codes;                    // base id -> tile code
+    std::vector<int> variants;                              // base id * TILE_ROTATIONS + rotation -> tile id, -1 if absent
+    std::vector<unsigned int> tile_bases;                   // tile id -> base id
+    std::vector<uint8_t> tile_rotations;                    // tile id -> rotation
     std::vector<QVector4D> uvs;
     std::vector<QVector3D> colors;
 
 public:
-    TileManager();
+    /**
+     * @brief      Constructs a new instance.
+     *
+     * @param[in]  catalogue  Optional tile catalogue (.json) of a custom tile
+     *                        pack; when empty, the built-in catalogue is used
+     */
+    TileManager(const QString& catalogue = QString());
 
     inline const QVector4D& get_uv(unsigned int id) const {
         return this->uvs[id];
@@ -63,10 +79,148 @@ public:
      */
     unsigned int get_tile_id(const std::string& tile_id) const;
 
+    /**
+     * @brief      Gets the tile identifier from a tile code and rotation angle
+     *             without building the tile name, e.g. ("AF01", 60) for
+     *             AF01_060
+     *
+     * @param[in]  code   The tile code
+     * @param[in]  angle  The rotation angle in degrees
+     *
+     * @return     The tile identifier, -1 if the tile does not exist.
+     */
+    inline int get_tile_id(std::string_view code, unsigned int angle) const {
+        if(code.size() != 4 || angle % 60 != 0 || angle >= 360) {
+            return -1;
+        }
+        auto got = this->base_ids.find(pack_code(code));
+        return got != this->base_ids.end() ? this->get_variant(got->second, angle / 60) : -1;
+    }
+
     inline const std::string& get_tilename(unsigned int tile_id) const {
         return this->tilenames[tile_id];
     }
 
+    /**
+     * @brief      Get the number of tiles in the catalogue
+     */
+    inline size_t get_nr_tiles() const {
+        return this->tilenames.size();
+    }
+
+    /**
+     * @brief      Get the number of base tiles in the catalogue
+     */
+    inline size_t get_nr_bases() const {
+        return this->base_codes.size();
+    }
+
+    /**
+     * @brief      Get the base tile of a tile, i.e. the tile irrespective of
+     *             its rotation
+     *
+     * @param[in]  tile_id  The tile identifier
+     *
+     * @return     The base identifier
+     */
+    inline unsigned int base_of(unsigned int tile_id) const {
+        return this->tile_bases[tile_id];
+    }
+
+    /**
+     * @brief      Get the rotation of a tile in steps of 60 degrees
+     *
+     * @param[in]  tile_id  The tile identifier
+     *
+     * @return     The rotation (0-5)
+     */
+    inline unsigned int rotation_of(unsigned int tile_id) const {
+        return this->tile_rotations[tile_id];
+    }
+
+    /**
+     * @brief      Get the tile code of a base tile, e.g. AF01
+     *
+     * @param[in]  base_id  The base identifier
+     *
+     * @return     The tile code
+     */
+    inline const std::string& get_base_code(unsigned int base_id) const {
+        return this->base_codes[base_id];
+    }
+
+    /**
+     * @brief      Get a rotation of a base tile
+     *
+     * @param[in]  base_id   The base identifier
+     * @param[in]  rotation  The rotation (0-5)
+     *
+     * @return     The tile identifier, -1 if the base tile lacks this rotation
+     */
+    inline int get_variant(unsigned int base_id, unsigned int rotation) const {
+        return this->variants[base_id * TILE_ROTATIONS + rotation];
+    }
+
+    /**
+     * @brief      Rotate a tile by a number of 60 degree steps (counter-clockwise
+     *             for positive steps); rotations that do not exist in the
+     *             catalogue are skipped
+     *
+     * @param[in]  tile_id  The tile identifier
+     * @param[in]  steps    The number of steps
+     *
+     * @return     The tile identifier of the rotated tile
+     */
+    unsigned int rotate(unsigned int tile_id, int steps) const;
+
+    /**
+     * @brief      Sum numbers of tiles per tile id into numbers per base tile,
+     *             i.e. irrespective of rotation
+     *
+     * @param[in]  tile_counts  The numbers of tiles indexed by tile id
+     *
+     * @return     The numbers of tiles indexed by base id
+     */
+    std::vector<size_t> count_bases(const std::vector<size_t>& tile_counts) const;
+
 private:
+    /**
+     * @brief      Load the tile catalogue from a json file
+     *
+     * @param[in]  filename  The filename
+     */
+    void load_catalogue(const QString& filename);
+
+#ifdef USE_GENERATED_TILE_CATALOGUE
+    /**
+     * @brief      Load the tile catalogue that was generated at build time
+     */
+    void load_generated_catalogue();
+#endif
+
+    /**
+     * @brief      Add a tile to the catalogue
+     *
+     * @param[in]  name  The tile name
+     * @param[in]  uv    The texture coordinates in the atlas
+     */
+    void add_tile(const std::string& name, const QVector4D& uv);
+
     QVector3D get_color_from_tilecode(const std::string& tile_id) const;
+
+    /**
+     * @brief      Register a tile as a rotation of a base tile
+     *
+     * @param[in]  name     The tile name
+     * @param[in]  tile_id  The tile identifier
+     */
+    void add_variant(const std::string& name, unsigned int tile_id);
+
+    /**
+     * @brief      Pack a four-character tile code into a key
+     */
+    static inline uint32_t pack_code(std::string_view code) {
+        return ((uint32_t)(uint8_t)code[0] << 24) | ((uint32_t)(uint8_t)code[1] << 16) |
+               ((uint32_t)(uint8_t)code[2] << 8) | (uint32_t)(uint8_t)code[3];
+    }
 };
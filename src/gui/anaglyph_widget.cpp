@@ -37,11 +37,16 @@ AnaglyphWidget::AnaglyphWidget(
 
     this->shader_manager = std::make_shared<ShaderProgramManager>();
 
-    auto pTimer = new QTimer(this);
-    pTimer->start(1000 / 60.0);
-
     this->setMouseTracking(true);
 
+    // repaint at full resolution once the camera has stopped moving
+    this->idle_timer = new QTimer(this);
+    this->idle_timer->setSingleShot(true);
+    this->idle_timer->setInterval(idle_delay);
+    connect(this->idle_timer, SIGNAL(timeout()), this, SLOT(request_frame()));
+
+    // frames are only rendered on request; while the camera is animated the
+    // next frame is requested once the previous one has been presented
     connect(this, SIGNAL(frameSwapped()), this, SLOT(action_frame_swapped()));
 }
 
@@ -75,6 +80,9 @@ QSize AnaglyphWidget::sizeHint() const {
  */
 void AnaglyphWidget::cleanup() {
     makeCurrent();
+    this->map_renderer.reset();
+    delete this->fbo;
+    this->fbo = nullptr;
     doneCurrent();
 }
 
@@ -93,7 +101,6 @@ void AnaglyphWidget::initializeGL() {
     this->load_shaders();
 
     this->blitter.create();
-    this->fbo = new QOpenGLFramebufferObject(this->size() * this->aa);
 
     this->set_projection_matrix();
     emit(opengl_ready());
@@ -103,29 +110,100 @@ void AnaglyphWidget::initializeGL() {
  * @brief      Render scene
  */
 void AnaglyphWidget::paintGL() {
-    this->fbo->bind();
+    this->flag_frame_requested = false;
+    this->advance_drag();
+
+    const QSize screen_size = this->size() * this->devicePixelRatioF();
+    const float scale = this->get_render_scale();
+
+    // the window surface is multisampled, see main.cpp
+    if(scale == 0.0f) {
+        delete this->fbo;
+        this->fbo = nullptr;
+    } else {
+        // the target is sized for full supersampling such that it is not
+        // reallocated when the resolution changes while the camera moves
+        this->ensure_framebuffer(screen_size * supersample_scale);
+        this->fbo->bind();
+    }
 
+    const QSize render_size = scale == 0.0f ? screen_size : screen_size * scale;
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glEnable(GL_BLEND);
     glEnable(GL_MULTISAMPLE);
     glEnable(GL_DEPTH_TEST);
     glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
     glBlendEquation(GL_FUNC_ADD);
-    glViewport(0, 0, this->width() * this->aa, this->height() * this->aa);
+    glViewport(0, 0, render_size.width(), render_size.height());
     this->map_renderer->draw();
-    this->fbo->release();
 
-    glViewport(0, 0, this->width(), this->height());
+    if(this->fbo == nullptr) {
+        return;
+    }
+
+    // downsample the rendered part of the target onto the screen
+    glBindFramebuffer(GL_FRAMEBUFFER, this->defaultFramebufferObject());
+    glViewport(0, 0, screen_size.width(), screen_size.height());
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
 
     blitter.bind();
-    const QRect targetRect(QPoint(0, 0), this->fbo->size());
-    const QMatrix4x4 target = QOpenGLTextureBlitter::targetTransform(targetRect, QRect(QPoint(0, 0), this->fbo->size()));
-    blitter.blit(this->fbo->texture(), target, QOpenGLTextureBlitter::OriginBottomLeft);
+    const QRect screen_rect(QPoint(0, 0), screen_size);
+    const QMatrix4x4 target = QOpenGLTextureBlitter::targetTransform(screen_rect, screen_rect);
+    const QMatrix3x3 source = QOpenGLTextureBlitter::sourceTransform(QRectF(QPointF(0, 0), render_size), this->fbo->size(), QOpenGLTextureBlitter::OriginBottomLeft);
+    blitter.blit(this->fbo->texture(), target, source);
     blitter.release();
 
     // this->map_renderer->draw_debug();
 }
 
+/**
+ * @brief      Get the resolution at which the next frame is rendered
+ *             relative to the screen
+ *
+ * @return     The scale, zero when rendering directly to the screen
+ */
+float AnaglyphWidget::get_render_scale() {
+    switch(this->render_quality) {
+        case RenderQuality::Multisample:
+            return 0.0f;
+        case RenderQuality::Supersample:
+            return supersample_scale;
+        case RenderQuality::Dynamic: {
+            // any change of the camera counts as motion
+            const QMatrix4x4 viewprojection = this->scene->projection * this->scene->view;
+            if(viewprojection != this->last_viewprojection) {
+                this->last_viewprojection = viewprojection;
+                this->idle_timer->start();
+            }
+            return this->idle_timer->isActive() ? motion_scale : supersample_scale;
+        }
+    }
+
+    return supersample_scale;
+}
+
+/**
+ * @brief      Make sure the offscreen target has a given size; it is only
+ *             reallocated when the size changes
+ *
+ * @param[in]  size  The size
+ */
+void AnaglyphWidget::ensure_framebuffer(const QSize& size) {
+    if(this->fbo != nullptr && this->fbo->size() == size) {
+        return;
+    }
+
+    delete this->fbo;
+    this->fbo = new QOpenGLFramebufferObject(size, QOpenGLFramebufferObject::CombinedDepthStencil);
+
+    // downsampling averages neighbouring texels
+    glBindTexture(GL_TEXTURE_2D, this->fbo->texture());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 /**
  * @brief      Resize window
  *
@@ -137,9 +215,6 @@ void AnaglyphWidget::resizeGL(int w, int h) {
     this->scene->canvas_width = w;
     this->scene->canvas_height = h;
     this->set_projection_matrix();
-
-    delete this->fbo;
-    this->fbo = new QOpenGLFramebufferObject(this->size() * this->aa);
 }
 
 /**
@@ -152,7 +227,17 @@ void AnaglyphWidget::mousePressEvent(QMouseEvent *event) {
     if (event->buttons() & Qt::RightButton && !this->flag_drag_map) {
         this->setCursor(Qt::SizeAllCursor);
         this->mouse_drag_center = event->pos();
+        this->mouse_lastpos = event->pos();
         this->flag_drag_map = true;
+        this->drag_clock.start();
+        this->request_frame();
+    }
+
+    // dragging with the left button selects a rectangle
+    if (event->button() == Qt::LeftButton && !this->flag_select_region) {
+        this->setCursor(Qt::CrossCursor);
+        this->select_from = this->scene->get_hexpos_at_mousepos(event->pos());
+        this->flag_select_region = true;
     }
 }
 
@@ -166,6 +251,15 @@ void AnaglyphWidget::mouseReleaseEvent(QMouseEvent *event) {
         this->setCursor(Qt::ArrowCursor);
         this->flag_drag_map = false;
         this->scene->set_dragging(false);
+        this->request_frame();
+    }
+
+    if (this->flag_select_region && event->button() == Qt::LeftButton) {
+        this->setCursor(Qt::ArrowCursor);
+        this->flag_select_region = false;
+        emit(region_selected(this->select_from,
+                             this->scene->get_hexpos_at_mousepos(event->pos()),
+                             event->modifiers()));
     }
 }
 
@@ -177,15 +271,16 @@ void AnaglyphWidget::mouseReleaseEvent(QMouseEvent *event) {
 void AnaglyphWidget::mouseMoveEvent(QMouseEvent *event) {
     this->setFocus(Qt::MouseFocusReason);
 
+    // a drag without offset does not animate, see action_frame_swapped; it
+    // resumes once the cursor leaves the position where dragging started
+    const bool drag_at_rest = this->flag_drag_map && this->mouse_lastpos == this->mouse_drag_center;
     this->mouse_lastpos = event->pos();
+    if (drag_at_rest && this->mouse_lastpos != this->mouse_drag_center) {
+        this->drag_clock.restart();
+        this->request_frame();
+    }
 
-    QVector3D ray_origin;
-    QVector3D ray_direction;
-
-    this->scene->calculate_ray(event->pos(), &ray_origin, &ray_direction);
-    auto pos = this->scene->calculate_ray_plane_intersection(ray_origin, ray_direction, QVector3D(0.0, 0.0, 0.0), QVector3D(0.0, 0.0, 1.0));
-    pos += this->scene->camera_look_at;
-    this->scene->set_mouse_pos(pos);
+    this->scene->set_mouse_pos(this->scene->get_worldpos_at_mousepos(event->pos()));
 }
 
 /**
@@ -194,8 +289,10 @@ void AnaglyphWidget::mouseMoveEvent(QMouseEvent *event) {
  * @param      event  The event
  */
 void AnaglyphWidget::wheelEvent(QWheelEvent *event) {
-    this->scene->camera_position += event->delta() * 0.01f * QVector3D(0, 0, 1);
-    this->scene->camera_position[2] = glm::clamp(this->scene->camera_position[2], 4.0f, 40.0f);
+    // zoom in steps proportional to the distance such that far zoom levels,
+    // where chunks are drawn as impostors, remain reachable
+    this->scene->camera_position += event->delta() * 0.001f * this->scene->camera_position[2] * QVector3D(0, 0, 1);
+    this->scene->camera_position[2] = glm::clamp(this->scene->camera_position[2], 4.0f, 160.0f);
 
     float w = (float)this->scene->canvas_width;
     float h = (float)this->scene->canvas_height;
@@ -203,15 +300,27 @@ void AnaglyphWidget::wheelEvent(QWheelEvent *event) {
     float zoom = -this->scene->camera_position[2];
     this->scene->update_view();
 
-    this->scene->projection.setToIdentity();
-    this->scene->projection.ortho(-zoom/2.0f, zoom/2.0f, -zoom / ratio /2.0f, zoom / ratio / 2.0f, 0.01f, 1000.0f);
+    QMatrix4x4 projection;
+    projection.ortho(-zoom/2.0f, zoom/2.0f, -zoom / ratio /2.0f, zoom / ratio / 2.0f, 0.01f, 1000.0f);
+    this->scene->set_projection(projection);
 
-    this->update();
+    this->request_frame();
 }
 
 void AnaglyphWidget::window_move_event() {
+    // the contents do not change when the window moves
     this->top_left = mapToGlobal(QPoint(0, 0));
-    this->update();
+}
+
+/**
+ * @brief      Request a repaint; all requests made before the next frame
+ *             is rendered result in a single frame
+ */
+void AnaglyphWidget::request_frame() {
+    if(!this->flag_frame_requested) {
+        this->flag_frame_requested = true;
+        this->update();
+    }
 }
 
 /**
@@ -223,8 +332,9 @@ void AnaglyphWidget::window_move_event() {
  */
 void AnaglyphWidget::load_shaders() {
     // create regular shaders
-    shader_manager->create_shader_program("sprite_shader", ShaderProgramType::SpriteShader, ":/assets/shaders/sprite.vs", ":/assets/shaders/sprite.fs");
-    shader_manager->create_shader_program("background_shader", ShaderProgramType::SpriteShader, ":/assets/shaders/background.vs", ":/assets/shaders/background.fs");
+    shader_manager->create_shader_program("sprite_shader", ShaderProgramType::InstancedSpriteShader, ":/assets/shaders/sprite.vs", ":/assets/shaders/sprite.fs");
+    shader_manager->create_shader_program("background_shader", ShaderProgramType::BackgroundShader, ":/assets/shaders/background.vs", ":/assets/shaders/background.fs");
+    shader_manager->create_shader_program("impostor_shader", ShaderProgramType::ImpostorShader, ":/assets/shaders/impostor.vs", ":/assets/shaders/impostor.fs");
     shader_manager->create_shader_program("line_shader", ShaderProgramType::SpriteShader, ":/assets/shaders/line.vs", ":/assets/shaders/line.fs");
 }
 
@@ -238,23 +348,39 @@ void AnaglyphWidget::set_projection_matrix() {
     float h = (float)this->scene->canvas_height;
     float ratio = w/h;
     float zoom = -this->scene->camera_position[2];
-    this->scene->projection.setToIdentity();
-    this->scene->projection.ortho(-zoom/2.0f, zoom/2.0f, -zoom / ratio /2.0f, zoom / ratio / 2.0f, 0.01f, 1000.0f);
+    QMatrix4x4 projection;
+    projection.ortho(-zoom/2.0f, zoom/2.0f, -zoom / ratio /2.0f, zoom / ratio / 2.0f, 0.01f, 1000.0f);
+    this->scene->set_projection(projection);
+}
+
+/**
+ * @brief      Move the camera while the map is dragged; the camera moves
+ *             with a velocity proportional to the distance of the cursor
+ *             from the position where dragging started
+ */
+void AnaglyphWidget::advance_drag() {
+    if (!this->flag_drag_map) {
+        return;
+    }
+
+    // time-based such that the velocity does not depend on the frame rate;
+    // long pauses between frames are not made up for
+    const float dt = std::min(this->drag_clock.restart(), max_drag_step) / 1000.0f;
+
+    QPoint position_difference = this->mouse_drag_center - this->mouse_lastpos;
+    this->scene->set_dragging(true);
+    this->scene->camera_position += QVector3D(-position_difference.x(), position_difference.y(), 0.0) * drag_speed * dt;
+    this->scene->camera_look_at += QVector3D(-position_difference.x(), position_difference.y(), 0.0) * drag_speed * dt;
+    this->scene->update_view();
 }
 
 /**
  * @brief      Action to conduct when a frame is swapped
  */
 void AnaglyphWidget::action_frame_swapped() {
-    static const float drag_intensity = 0.0005f;
-
-    if (this->flag_drag_map) {
-        QPoint position_difference = this->mouse_drag_center - this->mouse_lastpos;
-        this->scene->set_dragging(true);
-        this->scene->camera_position += QVector3D(-position_difference.x(), position_difference.y(), 0.0) * drag_intensity;
-        this->scene->camera_look_at += QVector3D(-position_difference.x(), position_difference.y(), 0.0) * drag_intensity;
-        this->scene->update_view();
-        this->update();
-        return;
+    // keep animating while the camera moves; presenting a frame waits for
+    // the vertical sync, hence at most one frame is rendered per refresh
+    if (this->flag_drag_map && this->mouse_lastpos != this->mouse_drag_center) {
+        this->request_frame();
     }
 }
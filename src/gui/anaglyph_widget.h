@@ -34,6 +34,7 @@
 #include <QSysInfo>
 #include <QDebug>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QCursor>
 
 #include <QtCore/qmath.h>
@@ -61,6 +62,13 @@
 
 QT_FORWARD_DECLARE_CLASS(QOpenGLShaderProgram)
 
+// how the scene is anti-aliased
+enum class RenderQuality {
+    Multisample,    // render directly into the multisampled window surface
+    Supersample,    // render at twice the resolution and downsample
+    Dynamic         // supersample, but render at screen resolution while the camera moves
+};
+
 class AnaglyphWidget : public QOpenGLWidget, protected QOpenGLFunctions {
     Q_OBJECT
 
@@ -71,7 +79,7 @@ private:
     QPoint top_left;
 
     QOpenGLTextureBlitter blitter;
-    QOpenGLFramebufferObject *fbo;
+    QOpenGLFramebufferObject *fbo = nullptr;    // offscreen target, nullptr until needed
 
     std::shared_ptr<ShaderProgramManager> shader_manager;
     std::shared_ptr<Scene> scene;
@@ -82,9 +90,20 @@ private:
     QPoint mouse_lastpos;
     QPoint mouse_drag_center;
     bool flag_drag_map = false;
+    bool flag_select_region = false;        // whether a rectangle is being selected
+    QVector3D select_from;                  // hexcube coordinates where the selection started
+    QElapsedTimer drag_clock;               // time since the camera was last moved by dragging
+    bool flag_frame_requested = false;      // whether a repaint is pending
+    static constexpr float drag_speed = 0.03f;      // camera velocity per pixel of cursor offset, per second
+    static constexpr qint64 max_drag_step = 100;    // maximum time in ms that the camera moves in one frame
 
     // anti-aliasing
-    int aa = 4;
+    RenderQuality render_quality = RenderQuality::Supersample;
+    QMatrix4x4 last_viewprojection;     // camera of the previous frame, to detect motion
+    QTimer *idle_timer;                 // restores the full resolution once the camera rests
+    static constexpr float supersample_scale = 2.0f;    // resolution relative to the screen when supersampling
+    static constexpr float motion_scale = 1.0f;         // resolution relative to the screen while the camera moves
+    static constexpr int idle_delay = 250;              // time in ms without motion before the camera rests
 
 public:
     AnaglyphWidget(const std::shared_ptr<Scene>& _scene,
@@ -102,6 +121,32 @@ public:
     inline void set_map(const std::shared_ptr<Map>& _map) {
         this->map = _map;
         this->map_renderer->set_map(this->map);
+        this->request_frame();
+    }
+
+    /**
+     * @brief      Mark the cells within a screen aligned rectangle as selected
+     *
+     * @param[in]  from  Hexcube coordinates of the first corner
+     * @param[in]  to    Hexcube coordinates of the second corner
+     */
+    inline void set_selection(const QVector3D& from, const QVector3D& to) {
+        this->map_renderer->set_selection(from, to);
+        this->request_frame();
+    }
+
+    /**
+     * @brief      Set how the scene is anti-aliased
+     *
+     * @param[in]  _render_quality  The render quality
+     */
+    inline void set_render_quality(RenderQuality _render_quality) {
+        this->render_quality = _render_quality;
+        this->request_frame();
+    }
+
+    inline RenderQuality get_render_quality() const {
+        return this->render_quality;
     }
 
 public slots:
@@ -110,6 +155,12 @@ public slots:
      */
     void cleanup();
 
+    /**
+     * @brief      Request a repaint; all requests made before the next frame
+     *             is rendered result in a single frame
+     */
+    void request_frame();
+
 protected:
     /**
      * @brief      Initialize OpenGL environment
@@ -168,9 +219,31 @@ private:
      */
     void set_projection_matrix();
 
+    /**
+     * @brief      Get the resolution at which the next frame is rendered
+     *             relative to the screen
+     *
+     * @return     The scale
+     */
+    float get_render_scale();
+
+    /**
+     * @brief      Make sure the offscreen target has a given size; it is only
+     *             reallocated when the size changes
+     *
+     * @param[in]  size  The size
+     */
+    void ensure_framebuffer(const QSize& size);
+
+    /**
+     * @brief      Move the camera while the map is dragged
+     */
+    void advance_drag();
+
 private slots:
     /**
-     * @brief      Action to perform when a frame is swapped
+     * @brief      Action to perform when a frame is swapped; requests the
+     *             next frame while the camera is animated
      */
     void action_frame_swapped();
 
@@ -179,4 +252,13 @@ signals:
      * @brief      Send signal that opengl engine is ready
      */
     void opengl_ready();
+
+    /**
+     * @brief      Send signal that a rectangle of cells has been selected
+     *
+     * @param[in]  from       Hexcube coordinates of the first corner
+     * @param[in]  to         Hexcube coordinates of the second corner
+     * @param[in]  modifiers  The keyboard modifiers held on release
+     */
+    void region_selected(const QVector3D& from, const QVector3D& to, Qt::KeyboardModifiers modifiers);
 };
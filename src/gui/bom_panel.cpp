@@ -0,0 +1,168 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "bom_panel.h"
+
+/**
+ * @brief      Constructs a new instance.
+ *
+ * @param[in]  _tile_manager  The tile manager
+ * @param      parent         The parent
+ */
+BomPanel::BomPanel(const std::shared_ptr<TileManager>& _tile_manager, QWidget *parent) :
+    QWidget(parent),
+    tile_manager(_tile_manager) {
+
+    QVBoxLayout *layout = new QVBoxLayout();
+    this->setLayout(layout);
+
+    this->table = new QTableWidget(0, 5, this);
+    this->table->setHorizontalHeaderLabels(QStringList() << tr("Tile") << tr("Map") << tr("Selection") << tr("Owned") << tr("Balance"));
+    this->table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    this->table->verticalHeader()->setVisible(false);
+    this->table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    this->table->setSelectionMode(QAbstractItemView::NoSelection);
+    this->table->setColumnHidden(2, true);
+    this->table->setColumnHidden(3, true);
+    this->table->setColumnHidden(4, true);
+    layout->addWidget(this->table);
+
+    this->label_total = new QLabel();
+    layout->addWidget(this->label_total);
+
+    this->refresh_timer.setSingleShot(true);
+    this->refresh_timer.setInterval(refresh_delay);
+    connect(&this->refresh_timer, SIGNAL(timeout()), this, SLOT(refresh()));
+}
+
+/**
+ * @brief      Destroys the object.
+ */
+BomPanel::~BomPanel() {
+    if(this->map) {
+        this->map->remove_listener(this->listener_handle);
+    }
+}
+
+/**
+ * @brief      Sets the map.
+ *
+ * @param[in]  _map  The map
+ */
+void BomPanel::set_map(const std::shared_ptr<Map>& _map) {
+    if(this->map) {
+        this->map->remove_listener(this->listener_handle);
+    }
+
+    this->map = _map;
+    this->listener_handle = this->map->add_listener([this](MapEvent, int, int) {
+        if(!this->refresh_timer.isActive()) {
+            this->refresh_timer.start();
+        }
+    });
+    this->refresh();
+}
+
+/**
+ * @brief      Set the cells of which a separate count is shown
+ *
+ * @param[in]  _selection  The cells, empty to hide the count
+ */
+void BomPanel::set_selection(const std::vector<AxialCoordinate>& _selection) {
+    this->selection = _selection;
+    this->refresh();
+}
+
+/**
+ * @brief      Set the inventory against which the map is balanced
+ *
+ * @param[in]  _inventory  The inventory, nullptr to hide the balance
+ */
+void BomPanel::set_inventory(const std::shared_ptr<const Inventory>& _inventory) {
+    this->inventory = _inventory;
+    this->refresh();
+}
+
+/**
+ * @brief      Rebuild the table from the tile counts of the map
+ */
+void BomPanel::refresh() {
+    if(!this->map) {
+        return;
+    }
+
+    // the map counts its tiles, only the selection has to be visited
+    const std::vector<size_t> counts = this->tile_manager->count_bases(this->map->get_tile_counts());
+    const bool show_selection = !this->selection.empty();
+    std::vector<size_t> selection_counts(counts.size(), 0);
+    if(show_selection) {
+        selection_counts = this->tile_manager->count_bases(MapRegion::count_tiles(*this->map, this->selection));
+    }
+
+    // owned tiles are listed as well when balancing against an inventory
+    const bool show_balance = this->inventory != nullptr;
+    std::vector<int64_t> balance;
+    if(show_balance) {
+        balance = this->inventory->get_balance(counts);
+    }
+
+    std::vector<unsigned int> base_ids;
+    for(unsigned int i=0; i<counts.size(); i++) {
+        if(counts[i] > 0 || (show_balance && this->inventory->get_owned(i) > 0)) {
+            base_ids.push_back(i);
+        }
+    }
+    std::sort(base_ids.begin(), base_ids.end(), [this](unsigned int a, unsigned int b) {
+        return this->tile_manager->get_base_code(a) < this->tile_manager->get_base_code(b);
+    });
+
+    this->table->setRowCount(base_ids.size());
+    size_t total = 0;
+    size_t selection_total = 0;
+    int64_t shortage = 0;
+    for(unsigned int row=0; row<base_ids.size(); row++) {
+        const unsigned int base_id = base_ids[row];
+        this->table->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(this->tile_manager->get_base_code(base_id))));
+        this->table->setItem(row, 1, new QTableWidgetItem(QString::number(counts[base_id])));
+        this->table->setItem(row, 2, new QTableWidgetItem(QString::number(selection_counts[base_id])));
+        total += counts[base_id];
+        selection_total += selection_counts[base_id];
+
+        if(show_balance) {
+            this->table->setItem(row, 3, new QTableWidgetItem(QString::number(this->inventory->get_owned(base_id))));
+            QTableWidgetItem *item = new QTableWidgetItem(QString::number(balance[base_id]));
+            if(balance[base_id] < 0) {
+                item->setForeground(Qt::red);
+                shortage -= balance[base_id];
+            }
+            this->table->setItem(row, 4, item);
+        }
+    }
+    this->table->setColumnHidden(2, !show_selection);
+    this->table->setColumnHidden(3, !show_balance);
+    this->table->setColumnHidden(4, !show_balance);
+
+    QString text = show_selection ? tr("%1 tiles, %2 selected").arg(total).arg(selection_total) : tr("%1 tiles").arg(total);
+    if(show_balance) {
+        text += shortage > 0 ? tr(", %1 tiles short").arg(shortage) : tr(", buildable from the inventory");
+    }
+    this->label_total->setText(text);
+}
@@ -0,0 +1,104 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <QWidget>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QTimer>
+#include <QBrush>
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "../data/map.h"
+#include "../data/map_region.h"
+#include "../data/tile_manager.h"
+#include "../data/inventory.h"
+
+/**
+ * @brief      Panel showing the bill of materials of the map and of the
+ *             current selection, which follows every modification of the map
+ */
+class BomPanel : public QWidget {
+    Q_OBJECT
+
+private:
+    QTableWidget *table;
+    QLabel *label_total;
+
+    std::shared_ptr<TileManager> tile_manager;
+    std::shared_ptr<Map> map;
+    unsigned int listener_handle = 0;
+
+    std::vector<AxialCoordinate> selection;    // cells of which a separate count is shown
+    std::shared_ptr<const Inventory> inventory; // tiles that are owned, nullptr to hide the balance
+
+    // modifications only schedule a refresh, such that a region operation
+    // modifying many tiles results in a single refresh
+    QTimer refresh_timer;
+    static constexpr int refresh_delay = 100;   // time in ms between a modification and the refresh
+
+public:
+    /**
+     * @brief      Constructs a new instance.
+     *
+     * @param[in]  _tile_manager  The tile manager
+     * @param      parent         The parent
+     */
+    BomPanel(const std::shared_ptr<TileManager>& _tile_manager, QWidget *parent = nullptr);
+
+    /**
+     * @brief      Destroys the object.
+     */
+    ~BomPanel();
+
+    /**
+     * @brief      Sets the map.
+     *
+     * @param[in]  _map  The map
+     */
+    void set_map(const std::shared_ptr<Map>& _map);
+
+    /**
+     * @brief      Set the cells of which a separate count is shown
+     *
+     * @param[in]  _selection  The cells, empty to hide the count
+     */
+    void set_selection(const std::vector<AxialCoordinate>& _selection);
+
+    /**
+     * @brief      Set the inventory against which the map is balanced
+     *
+     * @param[in]  _inventory  The inventory, nullptr to hide the balance
+     */
+    void set_inventory(const std::shared_ptr<const Inventory>& _inventory);
+
+private slots:
+    /**
+     * @brief      Rebuild the table from the tile counts of the map
+     */
+    void refresh();
+};
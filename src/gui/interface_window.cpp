@@ -35,14 +35,15 @@ InterfaceWindow::InterfaceWindow(MainWindow *mw)
     this->scene = std::make_shared<Scene>();
 
     // add anaglyph widget
-    this->tile_manager = std::make_shared<TileManager>();
+    // a custom tile pack can be used by pointing to its catalogue
+    this->tile_manager = std::make_shared<TileManager>(QString::fromLocal8Bit(qgetenv("HEXTONTILER_TILE_CATALOGUE")));
     this->map_io = std::make_unique<MapIO>(this->tile_manager);
     this->anaglyph_widget = new AnaglyphWidget(this->scene, this->tile_manager, this);
     splitter->addWidget(this->anaglyph_widget);
     this->anaglyph_widget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
     // add tile selector widget
-    this->tile_selector = new TileSelector(this);
+    this->tile_selector = new TileSelector(this->tile_manager, this);
     splitter->addWidget(this->tile_selector);
 
     // put everything as central widget
@@ -54,12 +55,31 @@ InterfaceWindow::InterfaceWindow(MainWindow *mw)
     this->setLayout(mainLayout);
 
     this->map = std::make_shared<Map>();
-    this->map->add_tile(this->tile_manager->get_tile_id("AF02_000"), 0, 0, 0); // default empty map tile
+    this->map->add_tile(this->tile_manager->get_tile_id("AF02_000"), 0, 0); // default empty map tile
     this->user_action = std::make_shared<UserAction>(this->scene, this->map, this->tile_manager);
+    this->bom_panel = new BomPanel(this->tile_manager, this);
+    this->bom_panel->set_map(this->map);
+
+    // stamps are shared between all maps that are edited
+    this->stamp_library = std::make_shared<StampLibrary>(this->tile_manager);
+    if(QFileInfo::exists(get_stamp_filename())) {
+        try {
+            this->stamp_library->load(get_stamp_filename());
+        } catch(const std::exception& e) {
+            qWarning() << "Could not load stamp library:" << e.what();
+        }
+    }
 
     connect(this->anaglyph_widget, SIGNAL(opengl_ready()), this, SLOT(slot_opengl_ready()));
     connect(this->tile_selector, SIGNAL(signal_tile_selected(const QString&)), this->user_action.get(), SLOT(slot_new_tile(const QString&)));
-    connect(this->scene.get(), SIGNAL(signal_update_screen()), this->anaglyph_widget, SLOT(update()));
+    connect(this->scene.get(), SIGNAL(signal_update_screen()), this->anaglyph_widget, SLOT(request_frame()));
+    connect(this->anaglyph_widget, SIGNAL(region_selected(const QVector3D&, const QVector3D&, Qt::KeyboardModifiers)), this, SLOT(slot_region_selected(const QVector3D&, const QVector3D&, Qt::KeyboardModifiers)));
+    connect(&this->save_watcher, SIGNAL(finished()), this, SLOT(slot_save_finished()));
+    connect(this->user_action.get(), SIGNAL(inventory_exceeded(const QString&, int)), this, SIGNAL(inventory_exceeded(const QString&, int)));
+    connect(this->user_action.get(), SIGNAL(fill_too_large(int)), this, SIGNAL(fill_too_large(int)));
+
+    this->load_progress_timer.setInterval(100);
+    connect(&this->load_progress_timer, SIGNAL(timeout()), this, SLOT(slot_load_progress()));
 }
 
 /**
@@ -72,43 +92,59 @@ void InterfaceWindow::keyPressEvent(QKeyEvent *e) {
 
     if(e->key() == Qt::Key_A && e->modifiers() == Qt::ShiftModifier) {
         this->user_action->add_tile();
-        this->anaglyph_widget->update();
+        this->anaglyph_widget->request_frame();
     }
     else if(e->key() == Qt::Key_R && e->modifiers() == Qt::ShiftModifier) {
         this->user_action->rotate_tile();
-        this->anaglyph_widget->update();
+        this->anaglyph_widget->request_frame();
     }
     else if(e->key() == Qt::Key_S && e->modifiers() == Qt::ShiftModifier) {
         this->user_action->substitute_tile();
-        this->anaglyph_widget->update();
+        this->anaglyph_widget->request_frame();
+    }
+    else if(e->key() == Qt::Key_F && e->modifiers() == Qt::ShiftModifier) {
+        this->user_action->flood_fill();
+        this->anaglyph_widget->request_frame();
+    }
+    else if(e->key() == Qt::Key_BracketRight && e->modifiers() == Qt::NoModifier) {
+        this->user_action->set_brush_radius(this->user_action->get_brush_radius() + 1);
+    }
+    else if(e->key() == Qt::Key_BracketLeft && e->modifiers() == Qt::NoModifier) {
+        if(this->user_action->get_brush_radius() > 0) {
+            this->user_action->set_brush_radius(this->user_action->get_brush_radius() - 1);
+        }
+    }
+    else if(e->key() == Qt::Key_Escape && !this->load_watchers.empty()) {
+        this->cancel_loading();
+        emit(load_cancelled());
     }
     else if(e->key() == Qt::Key_Delete && e->modifiers() == Qt::NoModifier) {
         this->user_action->remove_tile();
-        this->anaglyph_widget->update();
+        this->anaglyph_widget->request_frame();
     }
     else if(e->key() == Qt::Key_W && e->modifiers() == Qt::NoModifier) {
         this->scene->camera_position += QVector3D(0.0, scroll_intensity, 0.0);
         this->scene->camera_look_at += QVector3D(0.0, scroll_intensity, 0.0);
         this->scene->update_view();
-        this->anaglyph_widget->update();
+        this->anaglyph_widget->request_frame();
     }
     else if(e->key() == Qt::Key_A && e->modifiers() == Qt::NoModifier) {
         this->scene->camera_position += QVector3D(-scroll_intensity, 0.0, 0.0);
         this->scene->camera_look_at += QVector3D(-scroll_intensity, 0.0, 0.0);
         this->scene->update_view();
-        this->anaglyph_widget->update();
+        this->anaglyph_widget->request_frame();
     }
     else if(e->key() == Qt::Key_S && e->modifiers() == Qt::NoModifier) {
         this->scene->camera_position += QVector3D(0.0, -scroll_intensity, 0.0);
         this->scene->camera_look_at += QVector3D(0.0, -scroll_intensity, 0.0);
         this->scene->update_view();
-        this->anaglyph_widget->update();
+        this->anaglyph_widget->request_frame();
     }
     else if(e->key() == Qt::Key_D && e->modifiers() == Qt::NoModifier) {
         this->scene->camera_position += QVector3D(scroll_intensity, 0.0, 0.0);
         this->scene->camera_look_at += QVector3D(scroll_intensity, 0.0, 0.0);
         this->scene->update_view();
-        this->anaglyph_widget->update();
+        this->anaglyph_widget->request_frame();
     }
     else {
         QWidget::keyPressEvent(e);
@@ -122,7 +158,7 @@ void InterfaceWindow::action_center_map() {
     this->scene->camera_position = QVector3D(0.0f, 0.0f, 10.0f);
     this->scene->camera_look_at = QVector3D(0.0f, 0.0f, 0.0f);
     this->scene->update_view();
-    this->anaglyph_widget->update();
+    this->anaglyph_widget->request_frame();
 }
 
 /**
@@ -140,6 +176,151 @@ void InterfaceWindow::action_build_bom() {
     message_box.exec();
 }
 
+/**
+ * @brief      Revert the most recent modification of the map
+ */
+void InterfaceWindow::action_undo() {
+    if(this->user_action->undo()) {
+        this->anaglyph_widget->request_frame();
+    }
+}
+
+/**
+ * @brief      Reapply the most recently reverted modification of the map
+ */
+void InterfaceWindow::action_redo() {
+    if(this->user_action->redo()) {
+        this->anaglyph_widget->request_frame();
+    }
+}
+
+/**
+ * @brief      Select a rectangle of cells for copying, or fill or clear it
+ *             when control is held
+ *
+ * @param[in]  from       Hexcube coordinates of the first corner
+ * @param[in]  to         Hexcube coordinates of the second corner
+ * @param[in]  modifiers  The keyboard modifiers
+ */
+void InterfaceWindow::slot_region_selected(const QVector3D& from, const QVector3D& to, Qt::KeyboardModifiers modifiers) {
+    if(modifiers & Qt::ControlModifier) {
+        this->user_action->fill_rectangle(from, to, modifiers & Qt::ShiftModifier);
+        this->anaglyph_widget->request_frame();
+    } else {
+        this->user_action->select_rectangle(from, to);
+        this->bom_panel->set_selection(this->user_action->get_selection());
+        this->anaglyph_widget->set_selection(from, to);
+    }
+}
+
+/**
+ * @brief      Copy the tiles of the selected rectangle to the clipboard
+ */
+void InterfaceWindow::action_copy() {
+    try {
+        emit(clipboard_changed(this->user_action->copy_selection()));
+    } catch(const std::exception& e) {
+        QMessageBox::critical(this, tr("Copy failed"), QString::fromStdString(e.what()));
+    }
+}
+
+/**
+ * @brief      Paste the clipboard at the highlighted cell
+ */
+void InterfaceWindow::action_paste() {
+    if(this->user_action->paste()) {
+        this->anaglyph_widget->request_frame();
+    }
+}
+
+/**
+ * @brief      Rotate the clipboard by 60 degrees counterclockwise on the
+ *             screen, in the same direction as a single tile is rotated
+ */
+void InterfaceWindow::action_rotate_clipboard() {
+    this->user_action->rotate_clipboard(1);
+}
+
+/**
+ * @brief      Store the clipboard in the stamp library, which is saved
+ *             immediately
+ *
+ * @param[in]  name  The name of the stamp
+ *
+ * @return     True if the stamp was stored, False otherwise.
+ */
+bool InterfaceWindow::save_stamp(const QString& name) {
+    auto clipboard = this->user_action->get_clipboard();
+    if(!clipboard || clipboard->empty()) {
+        QMessageBox::warning(this, tr("Save stamp"), tr("Copy a selection to the clipboard first."));
+        return false;
+    }
+
+    const QString filename = get_stamp_filename();
+    try {
+        QDir().mkpath(QFileInfo(filename).absolutePath());
+        this->stamp_library->add(name.toStdString(), clipboard);
+        this->stamp_library->save(filename);
+        return true;
+    } catch(const std::exception& e) {
+        QMessageBox::critical(this, tr("Save stamp"), QString::fromStdString(e.what()));
+        return false;
+    }
+}
+
+/**
+ * @brief      Place a stamp of the library on the clipboard
+ *
+ * @param[in]  name  The name of the stamp
+ */
+void InterfaceWindow::use_stamp(const QString& name) {
+    auto stamp = this->stamp_library->get(name.toStdString());
+    if(stamp) {
+        this->user_action->set_clipboard(stamp);
+        emit(clipboard_changed(stamp->size()));
+    }
+}
+
+/**
+ * @brief      Restrict editing to the tiles of an inventory file and
+ *             balance the map against it; failures are reported in a
+ *             message box
+ *
+ * @param[in]  filename  The filename
+ *
+ * @return     True if the inventory was loaded, False otherwise.
+ */
+bool InterfaceWindow::load_inventory(const QString& filename) {
+    auto inventory = std::make_shared<Inventory>(this->tile_manager);
+    try {
+        inventory->load(filename);
+    } catch(const std::exception& e) {
+        QMessageBox::critical(this, tr("Load inventory"), QString::fromStdString(e.what()));
+        return false;
+    }
+
+    this->user_action->set_inventory(inventory);
+    this->bom_panel->set_inventory(inventory);
+    return true;
+}
+
+/**
+ * @brief      Lift the restriction of an inventory
+ */
+void InterfaceWindow::action_clear_inventory() {
+    this->user_action->set_inventory(nullptr);
+    this->bom_panel->set_inventory(nullptr);
+}
+
+/**
+ * @brief      Get the file in which the stamp library is kept
+ *
+ * @return     The filename
+ */
+QString InterfaceWindow::get_stamp_filename() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/stamps.hts";
+}
+
 /**
  * @brief      OpenGL ready function
  */
@@ -148,16 +329,142 @@ void InterfaceWindow::slot_opengl_ready() {
 }
 
 /**
- * @brief      Opens a file.
+ * @brief      Destroys the object, writing pending saves and waiting for the
+ *             cancelled loads to finish
+ */
+InterfaceWindow::~InterfaceWindow() {
+    this->cancel_loading();
+    this->save_watcher.waitForFinished();
+
+    // cancelled loads stop at their next progress check; also wait for the
+    // ones cancelled earlier whose watchers have already been released
+    QThreadPool::globalInstance()->waitForDone();
+
+    // queued saves would otherwise be lost on exit
+    while(!this->save_queue.isEmpty()) {
+        this->start_save(this->save_queue.takeFirst());
+        this->save_watcher.waitForFinished();
+    }
+}
+
+/**
+ * @brief      Opens a file in the background, see open_files
  *
  * @param[in]  filename  The filename
  */
 void InterfaceWindow::open_file(const QString& filename) {
-    auto newmap = this->map_io->load(filename);
-    this->map = newmap;
-    this->anaglyph_widget->set_map(newmap);
-    this->user_action->set_map(newmap);
-    emit(new_file_loaded());
+    this->open_files(QStringList(filename));
+}
+
+/**
+ * @brief      Load files concurrently on worker threads; the map is only
+ *             replaced once all files are loaded, after which
+ *             file_load_failed is emitted for every file that failed and
+ *             file_loaded once for the last file that loaded, which is
+ *             the file that is shown
+ *
+ * @param[in]  filenames  The filenames
+ */
+void InterfaceWindow::open_files(const QStringList& filenames) {
+    // an empty selection leaves the loads in progress alone
+    if(filenames.isEmpty()) {
+        return;
+    }
+
+    this->cancel_loading();
+
+    for(const QString& filename : filenames) {
+        auto monitor = std::make_shared<MapIO::LoadMonitor>();
+        MapIO io(this->tile_manager);
+
+        auto watcher = new QFutureWatcher<LoadResult>(this);
+        connect(watcher, SIGNAL(finished()), this, SLOT(slot_load_finished()));
+        watcher->setFuture(QtConcurrent::run([io, monitor, filename]() mutable {
+            LoadResult result;
+            try {
+                result.map = io.load(filename, monitor.get());
+            } catch(const std::exception& e) {
+                result.error = e.what();
+            }
+            return result;
+        }));
+
+        this->load_filenames.append(filename);
+        this->load_monitors.push_back(monitor);
+        this->load_watchers.push_back(watcher);
+    }
+
+    this->load_progress_timer.start();
+}
+
+/**
+ * @brief      Cancel all loads that are in progress
+ */
+void InterfaceWindow::cancel_loading() {
+    // the workers own their monitor, such that they can finish on their own
+    for(auto& monitor : this->load_monitors) {
+        monitor->cancelled = true;
+    }
+    for(auto watcher : this->load_watchers) {
+        watcher->disconnect(this);
+        watcher->deleteLater();
+    }
+
+    this->load_filenames.clear();
+    this->load_monitors.clear();
+    this->load_watchers.clear();
+    this->load_progress_timer.stop();
+}
+
+/**
+ * @brief      Apply the loaded maps once all background loads are finished
+ */
+void InterfaceWindow::slot_load_finished() {
+    for(auto watcher : this->load_watchers) {
+        if(!watcher->isFinished()) {
+            return;
+        }
+    }
+
+    // files are applied in the order in which they were requested
+    int shown = -1;
+    std::shared_ptr<Map> newmap;
+    for(unsigned int i=0; i<this->load_watchers.size(); i++) {
+        const LoadResult result = this->load_watchers[i]->result();
+        if(result.map) {
+            newmap = result.map;
+            shown = i;
+        } else if(!result.error.isEmpty()) {
+            emit(file_load_failed(this->load_filenames[i], result.error));
+        }
+    }
+    const QString filename = shown >= 0 ? this->load_filenames[shown] : QString();
+    this->cancel_loading();
+
+    if(newmap) {
+        this->map = newmap;
+        this->anaglyph_widget->set_map(newmap);
+        this->user_action->set_map(newmap);
+        this->bom_panel->set_map(newmap);
+        emit(new_file_loaded());
+        emit(file_loaded(filename));
+    }
+}
+
+/**
+ * @brief      Report the combined progress of the background loads
+ */
+void InterfaceWindow::slot_load_progress() {
+    size_t done = 0;
+    size_t total = 0;
+    for(const auto& monitor : this->load_monitors) {
+        done += monitor->work_done;
+        total += monitor->work_total;
+    }
+
+    if(total > 0) {
+        emit(load_progress(done * 100 / total));
+    }
 }
 
 /**
@@ -166,5 +473,73 @@ void InterfaceWindow::open_file(const QString& filename) {
  * @param[in]  filename  The filename
  */
 void InterfaceWindow::save_file(const QString& filename) {
-    this->map_io->save(this->map, filename);
+    // saves finish in order: a new save waits in the queue until the
+    // previous one is reported by slot_save_finished
+    if(this->save_watcher.isRunning() || !this->save_queue.isEmpty()) {
+        this->save_queue.append(filename);
+        return;
+    }
+
+    this->start_save(filename);
+}
+
+/**
+ * @brief      Start writing the map to a file in the background
+ *
+ * @param[in]  filename  The filename
+ */
+void InterfaceWindow::start_save(const QString& filename) {
+    this->save_filename = filename;
+    this->save_watcher.setFuture(this->map_io->save_async(this->map, filename));
+}
+
+/**
+ * @brief      Render the map to a PNG image; the current color mode is
+ *             used and failures are reported in a message box
+ *
+ * @param[in]  filename  The filename
+ *
+ * @return     True if the image was written, False otherwise.
+ */
+bool InterfaceWindow::export_image(const QString& filename) {
+    MapExporter exporter(this->tile_manager);
+    exporter.set_tile_colors(this->scene->tile_colors);
+
+    // the image is rendered on the GUI thread, which requires the OpenGL
+    // context; events are processed between the bands and the dialog is
+    // modal such that the map cannot change during the export
+    QProgressDialog progress(tr("Exporting image..."), tr("Cancel"), 0, 100, this);
+    progress.setWindowModality(Qt::ApplicationModal);
+    progress.setMinimumDuration(500);
+    exporter.set_progress_callback([&progress](size_t rows, size_t total) {
+        progress.setValue((int)(rows * 100 / total));
+        QApplication::processEvents();
+        return !progress.wasCanceled();
+    });
+
+    try {
+        const bool finished = exporter.export_png(this->map, filename);
+        progress.reset();
+        return finished;
+    } catch(const std::exception& e) {
+        progress.reset();
+        QMessageBox::critical(this, tr("Export failed"), QString::fromStdString(e.what()));
+        return false;
+    }
+}
+
+/**
+ * @brief      Report the result of a background save
+ */
+void InterfaceWindow::slot_save_finished() {
+    const QString error = this->save_watcher.result();
+    if(error.isEmpty()) {
+        emit(file_saved(this->save_filename));
+    } else {
+        emit(file_save_failed(error));
+    }
+
+    if(!this->save_queue.isEmpty()) {
+        this->start_save(this->save_queue.takeFirst());
+    }
 }
@@ -37,12 +37,21 @@
 #include <QPushButton>
 #include <QTimer>
 #include <QSplitter>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QProgressDialog>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileInfo>
 
 #include "anaglyph_widget.h"
 #include "tile_selector.h"
 #include "mainwindow.h"
 #include "user_action.h"
+#include "bom_panel.h"
 #include "../data/map_io.h"
+#include "../data/stamp_library.h"
+#include "map_exporter.h"
 
 QT_BEGIN_NAMESPACE
 class QSlider;
@@ -51,6 +60,14 @@ QT_END_NAMESPACE
 
 class MainWindow; // forward declaration to avoid circular dependencies
 
+/**
+ * @brief      Result of loading a map on a worker thread
+ */
+struct LoadResult {
+    std::shared_ptr<Map> map;   // nullptr if the load failed or was cancelled
+    QString error;              // description of the failure, empty otherwise
+};
+
 class InterfaceWindow : public QWidget {
     Q_OBJECT
 
@@ -59,12 +76,25 @@ private:
 
     AnaglyphWidget *anaglyph_widget;
     TileSelector *tile_selector;
+    BomPanel *bom_panel;        // docked by the main window
 
     std::shared_ptr<UserAction> user_action;
     std::shared_ptr<Map> map;
     std::shared_ptr<Scene> scene;
     std::shared_ptr<TileManager> tile_manager;
     std::unique_ptr<MapIO> map_io;
+    std::shared_ptr<StampLibrary> stamp_library;
+
+    QFutureWatcher<QString> save_watcher;
+    QString save_filename;
+    QStringList save_queue;         // saves requested while another runs
+
+    // maps that are loaded in the background; once all loads are finished,
+    // the last map that loaded successfully is shown
+    QStringList load_filenames;
+    std::vector<std::shared_ptr<MapIO::LoadMonitor>> load_monitors;
+    std::vector<QFutureWatcher<LoadResult>*> load_watchers;
+    QTimer load_progress_timer;
 
 public:
     /**
@@ -74,6 +104,12 @@ public:
      */
     InterfaceWindow(MainWindow *mw);
 
+    /**
+     * @brief      Destroys the object, writing pending saves and waiting for the
+     *             cancelled loads to finish
+     */
+    ~InterfaceWindow();
+
     /**
      * @brief      Get pointer to anaglyph widget
      *
@@ -83,7 +119,61 @@ public:
         return this->anaglyph_widget;
     }
 
+    /**
+     * @brief      Get pointer to the bill of materials panel
+     *
+     * @return     The bill of materials panel.
+     */
+    inline BomPanel* get_bom_panel() {
+        return this->bom_panel;
+    }
+
+    inline const std::shared_ptr<StampLibrary>& get_stamp_library() const {
+        return this->stamp_library;
+    }
+
+    /**
+     * @brief      Store the clipboard in the stamp library, which is saved
+     *             immediately
+     *
+     * @param[in]  name  The name of the stamp
+     *
+     * @return     True if the stamp was stored, False otherwise.
+     */
+    bool save_stamp(const QString& name);
+
+    /**
+     * @brief      Place a stamp of the library on the clipboard
+     *
+     * @param[in]  name  The name of the stamp
+     */
+    void use_stamp(const QString& name);
+
+    /**
+     * @brief      Restrict editing to the tiles of an inventory file and
+     *             balance the map against it; failures are reported in a
+     *             message box
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     True if the inventory was loaded, False otherwise.
+     */
+    bool load_inventory(const QString& filename);
+
 private:
+    /**
+     * @brief      Get the file in which the stamp library is kept
+     *
+     * @return     The filename
+     */
+    static QString get_stamp_filename();
+
+    /**
+     * @brief      Start writing the map to a file in the background
+     *
+     * @param[in]  filename  The filename
+     */
+    void start_save(const QString& filename);
 
 
 protected:
@@ -96,19 +186,48 @@ protected:
 
 public slots:
     /**
-     * @brief      Opens a file.
+     * @brief      Opens a file in the background, see open_files
      *
      * @param[in]  filename  The filename
      */
     void open_file(const QString& filename);
 
     /**
-     * @brief      Save to a file.
+     * @brief      Load files concurrently on worker threads; the map is only
+     *             replaced once all files are loaded, after which
+     *             file_load_failed is emitted for every file that failed and
+     *             file_loaded once for the last file that loaded, which is
+     *             the file that is shown
+     *
+     * @param[in]  filenames  The filenames
+     */
+    void open_files(const QStringList& filenames);
+
+    /**
+     * @brief      Cancel all loads that are in progress
+     */
+    void cancel_loading();
+
+    /**
+     * @brief      Save to a file; the file is written in the background and
+     *             file_saved or file_save_failed is emitted when done. If
+     *             another save is running, this one is queued behind it.
      *
      * @param[in]  filename  The filename
      */
     void save_file(const QString& filename);
 
+    /**
+     * @brief      Render the map to a PNG image; the current color mode is
+     *             used, the progress is shown in a dialog that allows to
+     *             cancel and failures are reported in a message box
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     True if the image was written, False otherwise.
+     */
+    bool export_image(const QString& filename);
+
 private slots:
     /**
      * @brief      OpenGL ready function
@@ -125,7 +244,7 @@ private slots:
      */
     inline void action_toggle_colors() {
         this->scene->tile_colors = !this->scene->tile_colors;
-        this->anaglyph_widget->update();
+        this->anaglyph_widget->request_frame();
     }
 
     /**
@@ -133,9 +252,130 @@ private slots:
      */
     void action_build_bom();
 
+    /**
+     * @brief      Revert the most recent modification of the map
+     */
+    void action_undo();
+
+    /**
+     * @brief      Reapply the most recently reverted modification of the map
+     */
+    void action_redo();
+
+    /**
+     * @brief      Lift the restriction of an inventory
+     */
+    void action_clear_inventory();
+
+    /**
+     * @brief      Copy the tiles of the selected rectangle to the clipboard
+     */
+    void action_copy();
+
+    /**
+     * @brief      Paste the clipboard at the highlighted cell
+     */
+    void action_paste();
+
+    /**
+     * @brief      Rotate the clipboard by 60 degrees counterclockwise on the
+     *             screen, in the same direction as a single tile is rotated
+     */
+    void action_rotate_clipboard();
+
+    /**
+     * @brief      Select a rectangle of cells for copying, or fill or clear it
+     *             when control is held
+     *
+     * @param[in]  from       Hexcube coordinates of the first corner
+     * @param[in]  to         Hexcube coordinates of the second corner
+     * @param[in]  modifiers  The keyboard modifiers
+     */
+    void slot_region_selected(const QVector3D& from, const QVector3D& to, Qt::KeyboardModifiers modifiers);
+
+    /**
+     * @brief      Report the result of a background save
+     */
+    void slot_save_finished();
+
+    /**
+     * @brief      Apply the loaded maps once all background loads are finished
+     */
+    void slot_load_finished();
+
+    /**
+     * @brief      Report the combined progress of the background loads
+     */
+    void slot_load_progress();
+
 signals:
     /**
      * @brief      Signal when new file is loaded
      */
     void new_file_loaded();
+
+    /**
+     * @brief      Signal the progress of background loads
+     *
+     * @param[in]  percentage  The percentage of the work that is done
+     */
+    void load_progress(int percentage);
+
+    /**
+     * @brief      Signal when a file has been loaded and is shown
+     *
+     * @param[in]  filename  The filename
+     */
+    void file_loaded(const QString& filename);
+
+    /**
+     * @brief      Signal when a file could not be loaded
+     *
+     * @param[in]  filename  The filename
+     * @param[in]  message   The error message
+     */
+    void file_load_failed(const QString& filename, const QString& message);
+
+    /**
+     * @brief      Signal when loading has been cancelled
+     */
+    void load_cancelled();
+
+    /**
+     * @brief      Signal when a file has been saved
+     *
+     * @param[in]  filename  The filename
+     */
+    void file_saved(const QString& filename);
+
+    /**
+     * @brief      Signal when a file could not be saved
+     *
+     * @param[in]  message  The error message
+     */
+    void file_save_failed(const QString& message);
+
+    /**
+     * @brief      Signal when the clipboard has been replaced
+     *
+     * @param[in]  nr_tiles  Number of tiles on the clipboard
+     */
+    void clipboard_changed(int nr_tiles);
+
+    /**
+     * @brief      Signal that a modification was refused as the inventory
+     *             lacks tiles
+     *
+     * @param[in]  tilecode  Code of the base tile that is short
+     * @param[in]  shortage  Number of tiles that are lacking
+     */
+    void inventory_exceeded(const QString& tilecode, int shortage);
+
+    /**
+     * @brief      Signal that a flood fill was refused as the region is too
+     *             large
+     *
+     * @param[in]  max_cells  Maximum number of tiles of a flood fill
+     */
+    void fill_too_large(int max_cells);
 };
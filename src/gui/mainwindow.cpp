@@ -33,6 +33,7 @@ MainWindow::MainWindow() {
 
     // add drop-down menus
     QMenu *menu_file = menuBar->addMenu(tr("&File"));
+    QMenu *menu_edit = menuBar->addMenu(tr("&Edit"));
     QMenu *menu_view = menuBar->addMenu(tr("&View"));
     QMenu *menu_tools = menuBar->addMenu(tr("&Tools"));
     QMenu *menu_help = menuBar->addMenu(tr("&Help"));
@@ -40,14 +41,25 @@ MainWindow::MainWindow() {
     // actions for file menu
     QAction *action_open = new QAction(menu_file);
     QAction *action_save = new QAction(menu_file);
+    QAction *action_export_image = new QAction(menu_file);
     QAction *action_quit = new QAction(menu_file);
 
+    // actions for edit menu
+    QAction *action_undo = new QAction(menu_edit);
+    QAction *action_redo = new QAction(menu_edit);
+    QAction *action_copy = new QAction(menu_edit);
+    QAction *action_paste = new QAction(menu_edit);
+    QAction *action_rotate_clipboard = new QAction(menu_edit);
+    QAction *action_save_stamp = new QAction(menu_edit);
+
     // actions for view menu
     QAction *action_center_map = new QAction(menu_view);
     QAction *action_toggle_colors = new QAction(menu_view);
 
     // actions for tools menu
     QAction *action_construct_bom = new QAction(menu_tools);
+    QAction *action_load_inventory = new QAction(menu_tools);
+    QAction *action_clear_inventory = new QAction(menu_tools);
 
     // actions for help menu
     QAction *action_about = new QAction(menu_help);
@@ -59,10 +71,25 @@ MainWindow::MainWindow() {
     action_save->setText(tr("Save"));
     action_save->setShortcuts(QKeySequence::Save);
     action_save->setIcon(QIcon(":/assets/icons/save.png"));
+    action_export_image->setText(tr("Export image..."));
+    action_export_image->setShortcut(Qt::CTRL + Qt::Key_E);
     action_quit->setText(tr("Quit"));
     action_quit->setShortcut(Qt::CTRL + Qt::Key_Q);
     action_quit->setIcon(QIcon(":/assets/icons/close.png"));
 
+    // create actions for edit menu
+    action_undo->setText(tr("Undo"));
+    action_undo->setShortcuts(QKeySequence::Undo);
+    action_redo->setText(tr("Redo"));
+    action_redo->setShortcuts(QList<QKeySequence>() << QKeySequence(Qt::CTRL + Qt::Key_Y) << QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_Z));
+    action_copy->setText(tr("Copy selection"));
+    action_copy->setShortcuts(QKeySequence::Copy);
+    action_paste->setText(tr("Paste"));
+    action_paste->setShortcuts(QKeySequence::Paste);
+    action_rotate_clipboard->setText(tr("Rotate clipboard"));
+    action_rotate_clipboard->setShortcut(Qt::CTRL + Qt::Key_R);
+    action_save_stamp->setText(tr("Save clipboard as stamp..."));
+
     // create actions for view menu
     action_center_map->setText(tr("Center map"));
     action_center_map->setShortcut(Qt::Key_0);
@@ -75,6 +102,8 @@ MainWindow::MainWindow() {
     action_construct_bom->setText(tr("Construct Bill of Materials"));
     action_construct_bom->setShortcut(Qt::CTRL + Qt::Key_B);
     action_construct_bom->setIcon(QIcon(":/assets/icons/list.png"));
+    action_load_inventory->setText(tr("Load inventory..."));
+    action_clear_inventory->setText(tr("Clear inventory"));
 
     // create actions for about menu
     action_about->setText(tr("About"));
@@ -84,14 +113,69 @@ MainWindow::MainWindow() {
     // add actions to file menu
     menu_file->addAction(action_open);
     menu_file->addAction(action_save);
+    menu_file->addAction(action_export_image);
     menu_file->addAction(action_quit);
 
+    // add actions to edit menu
+    menu_edit->addAction(action_undo);
+    menu_edit->addAction(action_redo);
+    menu_edit->addSeparator();
+    menu_edit->addAction(action_copy);
+    menu_edit->addAction(action_paste);
+    menu_edit->addAction(action_rotate_clipboard);
+    menu_edit->addSeparator();
+    menu_edit->addAction(action_save_stamp);
+
+    // stamps submenu, listing the stamps in the library when it is opened
+    QMenu *menu_stamps = menu_edit->addMenu(tr("Stamps"));
+    connect(menu_stamps, &QMenu::aboutToShow, this, [this, menu_stamps]() {
+        menu_stamps->clear();
+        const auto names = this->interface_window->get_stamp_library()->get_names();
+        if(names.empty()) {
+            menu_stamps->addAction(tr("(empty)"))->setEnabled(false);
+        }
+        for(const std::string& name : names) {
+            const QString label = QString::fromStdString(name);
+            connect(menu_stamps->addAction(label), &QAction::triggered, this, [this, label]() {
+                this->interface_window->use_stamp(label);
+            });
+        }
+    });
+
     // add actions to view menu
     menu_view->addAction(action_center_map);
     menu_view->addAction(action_toggle_colors);
 
+    // render quality submenu, the options exclude each other
+    QMenu *menu_render_quality = menu_view->addMenu(tr("Render quality"));
+    QActionGroup *group_render_quality = new QActionGroup(menu_render_quality);
+    const std::vector<std::pair<QString, RenderQuality>> render_qualities = {
+        {tr("Multisampling (fastest)"), RenderQuality::Multisample},
+        {tr("2x supersampling"), RenderQuality::Supersample},
+        {tr("Dynamic resolution"), RenderQuality::Dynamic}
+    };
+    for(const auto& render_quality : render_qualities) {
+        QAction *action = menu_render_quality->addAction(render_quality.first);
+        action->setCheckable(true);
+        action->setActionGroup(group_render_quality);
+        action->setChecked(render_quality.second == this->interface_window->get_anaglyph_widget()->get_render_quality());
+        const RenderQuality quality = render_quality.second;
+        connect(action, &QAction::triggered, this, [this, quality]() {
+            this->interface_window->get_anaglyph_widget()->set_render_quality(quality);
+        });
+    }
+
+    // live bill of materials, docked next to the map
+    QDockWidget *dock_bom = new QDockWidget(tr("Bill of Materials"), this);
+    dock_bom->setWidget(this->interface_window->get_bom_panel());
+    this->addDockWidget(Qt::RightDockWidgetArea, dock_bom);
+    menu_view->addAction(dock_bom->toggleViewAction());
+
     // add actions to tools menu
     menu_tools->addAction(action_construct_bom);
+    menu_tools->addSeparator();
+    menu_tools->addAction(action_load_inventory);
+    menu_tools->addAction(action_clear_inventory);
 
     // add actions to help menu
     menu_help->addAction(action_about);
@@ -99,14 +183,68 @@ MainWindow::MainWindow() {
     // connect actions file menu
     connect(action_open, &QAction::triggered, this, &MainWindow::open);
     connect(action_save, &QAction::triggered, this, &MainWindow::save);
+    connect(action_export_image, &QAction::triggered, this, &MainWindow::export_image);
     connect(action_quit, &QAction::triggered, this, &MainWindow::exit);
 
+    // connect actions edit menu
+    connect(action_undo, SIGNAL(triggered()), this->interface_window, SLOT(action_undo()));
+    connect(action_redo, SIGNAL(triggered()), this->interface_window, SLOT(action_redo()));
+    connect(action_copy, SIGNAL(triggered()), this->interface_window, SLOT(action_copy()));
+    connect(action_paste, SIGNAL(triggered()), this->interface_window, SLOT(action_paste()));
+    connect(action_rotate_clipboard, SIGNAL(triggered()), this->interface_window, SLOT(action_rotate_clipboard()));
+    connect(action_save_stamp, &QAction::triggered, this, &MainWindow::save_stamp);
+
     // connect actions view menu
     connect(action_center_map, SIGNAL(triggered()), this->interface_window, SLOT(action_center_map()));
     connect(action_toggle_colors, SIGNAL(triggered()), this->interface_window, SLOT(action_toggle_colors()));
 
     // connect actions tools menu
     connect(action_construct_bom, SIGNAL(triggered()), this->interface_window, SLOT(action_build_bom()));
+    connect(action_load_inventory, &QAction::triggered, this, &MainWindow::load_inventory);
+    connect(action_clear_inventory, SIGNAL(triggered()), this->interface_window, SLOT(action_clear_inventory()));
+
+    // report the contents of the clipboard
+    connect(this->interface_window, &InterfaceWindow::clipboard_changed, this, [this](int nr_tiles) {
+        statusBar()->showMessage(QString("%1 tiles on the clipboard.").arg(nr_tiles), 5000);
+    });
+
+    // report modifications refused for lack of tiles
+    connect(this->interface_window, &InterfaceWindow::inventory_exceeded, this, [this](const QString& tilecode, int shortage) {
+        statusBar()->showMessage(QString("Not enough tiles in the inventory: %1 short of %2.").arg(shortage).arg(tilecode), 5000);
+    });
+
+    // report flood fills refused for their size
+    connect(this->interface_window, &InterfaceWindow::fill_too_large, this, [this](int max_cells) {
+        statusBar()->showMessage(QString("Fill refused: the region holds more than %1 tiles.").arg(max_cells), 5000);
+    });
+
+    // report background loads
+    connect(this->interface_window, &InterfaceWindow::load_progress, this, [this](int percentage) {
+        statusBar()->showMessage(QString("Loading... %1% (press Esc to cancel)").arg(percentage));
+    });
+    connect(this->interface_window, &InterfaceWindow::file_loaded, this, [this](const QString& filename) {
+        statusBar()->showMessage("Loaded " + filename + ".");
+        this->setWindowTitle(QFileInfo(filename).fileName() + " - " + QString(PROGRAM_NAME));
+    });
+    connect(this->interface_window, &InterfaceWindow::file_load_failed, this, [this](const QString& filename, const QString& message) {
+        statusBar()->showMessage("Error loading file.");
+        QMessageBox::critical(this, tr("Failed to load file"), tr("Could not load %1:\n%2").arg(filename).arg(message));
+    });
+    connect(this->interface_window, &InterfaceWindow::load_cancelled, this, [this]() {
+        statusBar()->showMessage("Loading cancelled.");
+    });
+
+    // report background saves
+    connect(this->interface_window, &InterfaceWindow::file_saved, this, [this](const QString& filename) {
+        statusBar()->showMessage("Saved to " + filename + ".");
+
+        // only rename the document once it has actually been written
+        this->setWindowTitle(QFileInfo(filename).fileName() + " - " + QString(PROGRAM_NAME));
+    });
+    connect(this->interface_window, &InterfaceWindow::file_save_failed, this, [this](const QString& message) {
+        statusBar()->showMessage("Error saving file.");
+        QMessageBox::critical(this, tr("Error saving file"), message);
+    });
 
     // connect actions about menu
     connect(action_about, &QAction::triggered, this, &MainWindow::about);
@@ -125,36 +263,79 @@ MainWindow::MainWindow() {
  * @brief      Open a new object file
  */
 void MainWindow::open() {
-    QString filename = QFileDialog::getOpenFileName(this, tr("Open file"), "", tr("Hexton tile map (*.htm);;"));
+    QString filename = QFileDialog::getOpenFileName(this, tr("Open file"), "", tr("Hexton tile map (*.htm);;Binary hexton tile map (*.htb);;"));
 
     if(filename.isEmpty()) {
         return;
     }
 
-    // display load time
+    // the file is loaded in the background, see file_loaded
     this->interface_window->open_file(filename);
-    statusBar()->showMessage("Loaded " + filename + ".");
-
-    // set main window title
-    this->setWindowTitle(QFileInfo(filename).fileName() + " - " + QString(PROGRAM_NAME));
+    statusBar()->showMessage("Loading " + filename + "...");
 }
 
 /**
  * @brief      Open a new object file
  */
 void MainWindow::save() {
-    QString filename = QFileDialog::getSaveFileName(this, tr("Save file"), "", tr("Hexon tile map (*.htm);;"));
+    QString filename = QFileDialog::getSaveFileName(this, tr("Save file"), "", tr("Hexton tile map (*.htm);;Binary hexton tile map (*.htb);;"));
 
     if(filename.isEmpty()) {
         return;
     }
 
-    // display load time
+    // the file is written in the background, see file_saved
     this->interface_window->save_file(filename);
-    statusBar()->showMessage("Saved to " + filename + ".");
+    statusBar()->showMessage("Saving to " + filename + "...");
+}
+
+/**
+ * @brief      Export map to an image
+ */
+void MainWindow::export_image() {
+    QString filename = QFileDialog::getSaveFileName(this, tr("Export image"), "", tr("PNG image (*.png)"));
+
+    if(filename.isEmpty()) {
+        return;
+    }
+
+    statusBar()->showMessage("Exporting to " + filename + "...");
+    if(this->interface_window->export_image(filename)) {
+        statusBar()->showMessage("Exported " + filename, 5000);
+    } else {
+        statusBar()->clearMessage();
+    }
+}
+
+/**
+ * @brief      Store the clipboard as a stamp under a name asked from the user
+ */
+void MainWindow::save_stamp() {
+    bool ok = false;
+    const QString name = QInputDialog::getText(this, tr("Save stamp"), tr("Name of the stamp:"), QLineEdit::Normal, "", &ok).trimmed();
+
+    if(!ok || name.isEmpty()) {
+        return;
+    }
+
+    if(this->interface_window->save_stamp(name)) {
+        statusBar()->showMessage("Saved stamp " + name + ".", 5000);
+    }
+}
+
+/**
+ * @brief      Load an inventory to which editing is restricted
+ */
+void MainWindow::load_inventory() {
+    QString filename = QFileDialog::getOpenFileName(this, tr("Load inventory"), "", tr("Inventory (*.txt);;All files (*)"));
+
+    if(filename.isEmpty()) {
+        return;
+    }
 
-    // set main window title
-    this->setWindowTitle(QFileInfo(filename).fileName() + " - " + QString(PROGRAM_NAME));
+    if(this->interface_window->load_inventory(filename)) {
+        statusBar()->showMessage("Loaded inventory " + filename + ".", 5000);
+    }
 }
 
 /**
@@ -252,13 +433,13 @@ void MainWindow::dropEvent(QDropEvent *event) {
 
     if (mimeData->hasUrls()) {
         QList<QUrl> urlList = mimeData->urls();
-        QString text;
+        QStringList filenames;
         for (int i = 0; i < urlList.size() && i < 32; ++i) {
             QString url = urlList.at(i).path();
 
             // check if file exists, else show error message
             if(boost::filesystem::exists(url.toStdString())) {
-                this->interface_window->open_file(url);
+                filenames.append(url);
             } else {
                 QMessageBox::critical(this, tr("Failed to load file"), tr("Could not load file. Did you try to load this file from a network drive? This is not supported.") );
                 statusBar()->showMessage("Error loading file.");
@@ -266,12 +447,9 @@ void MainWindow::dropEvent(QDropEvent *event) {
             }
         }
 
-        // show message after loading
-        if(urlList.size() == 1) {
-            statusBar()->showMessage("Loaded " + urlList.at(0).path() + ".");
-        } else {
-            statusBar()->showMessage("Loaded files.");
-        }
+        // the files are loaded concurrently in the background, see file_loaded
+        this->interface_window->open_files(filenames);
+        statusBar()->showMessage(filenames.size() == 1 ? "Loading " + filenames.front() + "..." : QString("Loading files..."));
     } else {
         statusBar()->showMessage("Could not identify dropped format. Ignoring...");
     }
@@ -24,6 +24,7 @@
 #include <QMainWindow>
 #include <QMenuBar>
 #include <QMenu>
+#include <QActionGroup>
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QStatusBar>
@@ -31,6 +32,8 @@
 #include <QtWidgets/QApplication>
 #include <QFileInfo>
 #include <QMimeData>
+#include <QInputDialog>
+#include <QDockWidget>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
@@ -70,6 +73,21 @@ private slots:
      */
     void save();
 
+    /**
+     * @brief      Export map to an image
+     */
+    void export_image();
+
+    /**
+     * @brief      Store the clipboard as a stamp under a name asked from the user
+     */
+    void save_stamp();
+
+    /**
+     * @brief      Load an inventory to which editing is restricted
+     */
+    void load_inventory();
+
     /**
      * @brief      Close the application
      */
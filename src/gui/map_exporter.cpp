@@ -0,0 +1,221 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "map_exporter.h"
+
+/**
+ * @brief      Constructs a new instance.
+ *
+ * @param[in]  _tile_manager  The tile manager
+ */
+MapExporter::MapExporter(const std::shared_ptr<TileManager>& _tile_manager) :
+    tile_manager(_tile_manager) {
+
+}
+
+/**
+ * @brief      Render a map to a PNG image with a transparent background
+ *
+ * @param[in]  map       The map
+ * @param[in]  filename  The filename
+ *
+ * @return     False if the export was cancelled, True otherwise
+ */
+bool MapExporter::export_png(const std::shared_ptr<Map>& map, const QString& filename) const {
+    if(map->size() == 0) {
+        throw std::runtime_error("Cannot export an empty map");
+    }
+
+    // the exporter uses its own context on an offscreen surface such that it
+    // does not depend on any widget
+    QSurfaceFormat format;
+    format.setDepthBufferSize(24);
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+
+    QOpenGLContext context;
+    context.setFormat(format);
+    if(!context.create() || !context.makeCurrent(&surface)) {
+        throw std::runtime_error("Could not create an OpenGL context for exporting");
+    }
+
+    bool finished = false;
+    try {
+        finished = this->render(map, filename);
+    } catch(...) {
+        context.doneCurrent();
+        throw;
+    }
+    context.doneCurrent();
+
+    return finished;
+}
+
+/**
+ * @brief      Render the map using the current OpenGL context
+ *
+ * @param[in]  map       The map
+ * @param[in]  filename  The filename
+ *
+ * @return     False if the export was cancelled, True otherwise
+ */
+bool MapExporter::render(const std::shared_ptr<Map>& map, const QString& filename) const {
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    QSurface* surface = context->surface();
+    QOpenGLExtraFunctions *f = context->extraFunctions();
+
+    auto scene = std::make_shared<Scene>();
+    scene->tile_colors = this->tile_colors;
+    scene->tile_highlight = QVector3D(1.0f, 1.0f, 1.0f); // not a valid cell, hence nothing is highlighted
+
+    auto shader_manager = std::make_shared<ShaderProgramManager>();
+    shader_manager->create_shader_program("sprite_shader", ShaderProgramType::InstancedSpriteShader, ":/assets/shaders/sprite.vs", ":/assets/shaders/sprite.fs");
+
+    // every tile is rendered at full detail, irrespective of the tile size
+    MapRenderer renderer(shader_manager, scene, this->tile_manager);
+    renderer.set_impostors_enabled(false);
+    renderer.set_map(map);
+
+    // determine the extent of all sprites and center the camera on it
+    const QVector3D offset = scene->get_tile_offset(Scene::tiledist);
+    float xmin = std::numeric_limits<float>::max();
+    float ymin = std::numeric_limits<float>::max();
+    float xmax = -std::numeric_limits<float>::max();
+    float ymax = -std::numeric_limits<float>::max();
+    map->for_each_tile([&](const Tile& tile) {
+        const QVector3D center = scene->hexcube_to_cartesian(QVector3D(tile.x, tile.y, tile.z())) + offset;
+        xmin = std::min(xmin, center.x());
+        xmax = std::max(xmax, center.x());
+        ymin = std::min(ymin, center.y());
+        ymax = std::max(ymax, center.y());
+    });
+    scene->camera_look_at = QVector3D((xmin + xmax) / 2.0f, (ymin + ymax) / 2.0f, 0.0f);
+    scene->camera_position = scene->camera_look_at + QVector3D(0.0f, 0.0f, 10.0f);
+    scene->update_view();
+
+    // the view is centered, hence the image spans [-half_width, half_width]
+    // and [-half_height, half_height] in view space
+    const float half_width = (xmax - xmin + Scene::tiledist) / 2.0f;
+    const float half_height = (ymax - ymin + Scene::tiledist) / 2.0f;
+    const float scale = this->tile_size / Scene::tiledist;   // pixels per unit
+    const size_t width = (size_t)std::ceil(2.0f * half_width * scale);
+    const size_t height = (size_t)std::ceil(2.0f * half_height * scale);
+
+    // choose the size of the tiles in which the image is rendered
+    GLint max_texture_size = 0;
+    GLint max_renderbuffer_size = 0;
+    f->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+    f->glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &max_renderbuffer_size);
+    const size_t aa = this->supersampling;
+    const size_t max_size = std::min({max_texture_size, max_renderbuffer_size, max_framebuffer_size}) / aa;
+    if(max_size == 0) {
+        throw std::runtime_error("Supersampling factor exceeds the maximum framebuffer size");
+    }
+    const size_t tile_width = std::min(width, max_size);
+    const size_t band_height = std::max<size_t>(1, std::min({height, max_size, max_band_bytes / (width * 4)}));
+
+    QOpenGLFramebufferObject fbo(tile_width * aa, band_height * aa, QOpenGLFramebufferObject::CombinedDepthStencil);
+    std::vector<uint8_t> pixels(tile_width * aa * band_height * aa * 4);
+    std::vector<uint8_t> band(width * band_height * 4);
+
+    PngWriter writer(filename, width, height);
+    scene->canvas_width = tile_width;
+    scene->canvas_height = band_height;
+
+    for(size_t row0 = 0; row0 < height; row0 += band_height) {
+        const size_t rows = std::min(band_height, height - row0);
+
+        for(size_t col0 = 0; col0 < width; col0 += tile_width) {
+            const size_t cols = std::min(tile_width, width - col0);
+
+            // project the part of the view that corresponds to this tile; the
+            // editor mirrors both axes of the view (see AnaglyphWidget), hence
+            // the image starts at the largest x and the smallest y
+            const float left = half_width - col0 / scale;
+            const float top = -half_height + row0 / scale;
+            QMatrix4x4 projection;
+            projection.ortho(left, left - tile_width / scale, top + band_height / scale, top, 0.01f, 1000.0f);
+            scene->set_projection(projection);
+
+            // colors are accumulated premultiplied by alpha onto a transparent background
+            fbo.bind();
+            f->glViewport(0, 0, fbo.width(), fbo.height());
+            f->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            f->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            f->glEnable(GL_BLEND);
+            f->glEnable(GL_DEPTH_TEST);
+            f->glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            f->glBlendEquation(GL_FUNC_ADD);
+            renderer.draw_tiles();
+            f->glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            f->glReadPixels(0, 0, fbo.width(), fbo.height(), GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+            fbo.release();
+
+            // average the samples of every pixel; the framebuffer is stored
+            // bottom to top whereas the image is written top to bottom
+            const size_t fbo_width = fbo.width();
+            const size_t fbo_height = fbo.height();
+            for(size_t r=0; r<rows; r++) {
+                for(size_t c=0; c<cols; c++) {
+                    unsigned int sum[4] = {0, 0, 0, 0};
+                    for(size_t dy=0; dy<aa; dy++) {
+                        const uint8_t* sample = &pixels[((fbo_height - 1 - (r * aa + dy)) * fbo_width + c * aa) * 4];
+                        for(size_t dx=0; dx<aa * 4; dx++) {
+                            sum[dx % 4] += sample[dx];
+                        }
+                    }
+
+                    // PNG stores colors that are not premultiplied by alpha
+                    uint8_t* out = &band[(r * width + col0 + c) * 4];
+                    const unsigned int samples = aa * aa;
+                    const unsigned int alpha = sum[3];
+                    for(unsigned int k=0; k<3; k++) {
+                        out[k] = alpha > 0 ? (uint8_t)std::min(255u, (sum[k] * 255 + alpha / 2) / alpha) : 0;
+                    }
+                    out[3] = (uint8_t)((alpha + samples / 2) / samples);
+                }
+            }
+        }
+
+        for(size_t r=0; r<rows; r++) {
+            writer.write_row(&band[r * width * 4]);
+        }
+
+        // the callback may process events, during which widgets make their
+        // own context current; an unfinished image is discarded by the writer
+        if(this->progress) {
+            if(!this->progress(row0 + rows, height)) {
+                return false;
+            }
+            if(QOpenGLContext::currentContext() != context) {
+                context->makeCurrent(surface);
+            }
+        }
+    }
+
+    writer.finish();
+
+    return true;
+}
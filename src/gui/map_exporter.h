@@ -0,0 +1,133 @@
+/**************************************************************************
+ *   This file is part of HEXTONTILER.                                    *
+ *                                                                        *
+ *   Author: Ivo Filot <ivo@ivofilot.nl>                                  *
+ *                                                                        *
+ *   HEXTONTILER is free software:                                        *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   HEXTONTILER is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QOffscreenSurface>
+#include <QSurfaceFormat>
+#include <QString>
+
+#include <memory>
+#include <functional>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "map_renderer.h"
+#include "shader_program_manager.h"
+#include "scene.h"
+#include "../data/map.h"
+#include "../data/tile_manager.h"
+#include "../data/png_writer.h"
+
+/**
+ * @brief      Renders complete maps to PNG images of arbitrary size
+ *
+ *             The image is rendered in bands of framebuffer-sized tiles on
+ *             an offscreen surface, and every band is passed to the PNG
+ *             encoder before the next one is rendered. Neither the image
+ *             nor a framebuffer of the full image size is ever allocated,
+ *             and no window is required such that images can be exported
+ *             on the offscreen platform using a software rasterizer.
+ */
+class MapExporter {
+public:
+    // called with the number of rendered and total rows of the image after
+    // every band; returning false cancels the export
+    typedef std::function<bool(size_t, size_t)> ProgressCallback;
+
+private:
+    std::shared_ptr<TileManager> tile_manager;
+    ProgressCallback progress;
+
+    unsigned int tile_size = 128;       // width of a tile sprite in pixels
+    unsigned int supersampling = 2;     // samples per pixel along each axis
+    bool tile_colors = true;            // whether to render the tiles in their category color
+
+    // maximum framebuffer dimension that is used, irrespective of what the GPU supports
+    static constexpr int max_framebuffer_size = 4096;
+
+    // maximum size of a band of the image that is held in memory
+    static constexpr size_t max_band_bytes = 64 << 20;
+
+public:
+    /**
+     * @brief      Constructs a new instance.
+     *
+     * @param[in]  _tile_manager  The tile manager
+     */
+    MapExporter(const std::shared_ptr<TileManager>& _tile_manager);
+
+    /**
+     * @brief      Set the width of a tile sprite in pixels
+     */
+    inline void set_tile_size(unsigned int _tile_size) {
+        this->tile_size = std::max(1u, _tile_size);
+    }
+
+    /**
+     * @brief      Set the number of samples per pixel along each axis
+     */
+    inline void set_supersampling(unsigned int _supersampling) {
+        this->supersampling = std::max(1u, _supersampling);
+    }
+
+    /**
+     * @brief      Set whether tiles are rendered in their category color
+     */
+    inline void set_tile_colors(bool _tile_colors) {
+        this->tile_colors = _tile_colors;
+    }
+
+    /**
+     * @brief      Set the function that reports the progress of an export;
+     *             it may process events of the GUI thread
+     */
+    inline void set_progress_callback(const ProgressCallback& _progress) {
+        this->progress = _progress;
+    }
+
+    /**
+     * @brief      Render a map to a PNG image with a transparent background
+     *
+     * @param[in]  map       The map
+     * @param[in]  filename  The filename
+     *
+     * @return     False if the export was cancelled, True otherwise
+     */
+    bool export_png(const std::shared_ptr<Map>& map, const QString& filename) const;
+
+private:
+    /**
+     * @brief      Render the map using the current OpenGL context
+     *
+     * @param[in]  map       The map
+     * @param[in]  filename  The filename
+     *
+     * @return     False if the export was cancelled, True otherwise
+     */
+    bool render(const std::shared_ptr<Map>& map, const QString& filename) const;
+};
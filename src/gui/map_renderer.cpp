@@ -38,129 +38,178 @@ MapRenderer::MapRenderer(const std::shared_ptr<ShaderProgramManager>& _shader_ma
     this->build_vao();
 
     this->tilespackage = new QOpenGLTexture(QImage(QString(":/assets/tiles/tilespackage_isometric.png")));
+    this->template_tile_id = this->tile_manager->get_tile_id("ST00_000");
+
+    // sample zoomed out tiles from the mipmaps of the atlas; the tiles occupy
+    // power-of-two aligned cells, hence mipmaps only mix neighbouring tiles
+    // once a tile is reduced to a few texels
+    float cell = 1.0f;
+    for(unsigned int i=0; i<this->tile_manager->get_nr_tiles(); i++) {
+        const QVector4D& uv = this->tile_manager->get_uv(i);
+        cell = std::min({cell, std::fabs(uv[2] - uv[0]), std::fabs(uv[3] - uv[1])});
+    }
+    const float cell_texels = cell * std::min(this->tilespackage->width(), this->tilespackage->height());
+    this->tilespackage->setMipMaxLevel(std::max(0, (int)std::log2(std::max(cell_texels, 1.0f)) - 2));
+    this->tilespackage->setMinMagFilters(QOpenGLTexture::LinearMipMapLinear, QOpenGLTexture::Linear);
+}
+
+/**
+ * @brief      Destroys the object.
+ */
+MapRenderer::~MapRenderer() {
+    if(this->map) {
+        this->map->remove_listener(this->listener_handle);
+    }
+
+    // requires the context of the renderer to be current
+    delete this->tilespackage;
 }
 
 /**
- * @brief      Draw the actual tiles
+ * @brief      Draw the background and the tiles
  */
 void MapRenderer::draw() {
     this->draw_template_map();
+    this->draw_tiles();
+}
 
+/**
+ * @brief      Draw the tiles of the map without the background
+ */
+void MapRenderer::draw_tiles() {
     ShaderProgram *model_shader = this->shader_manager->get_shader_program("sprite_shader");
     model_shader->bind();
 
-    QMatrix4x4 model;
-    model.setToIdentity();
-    QMatrix4x4 mvp = this->scene->projection * this->scene->view * model;
-
-    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
-
-    // draw tile
-    this->vao.bind();
-    this->tilespackage->bind();
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
 
     auto tilehighlight = this->scene->get_hexpos_highlight();
-    bool highlight = false;
-
-    for(const auto& tile : this->map->get_tiles()) {
-        model.setToIdentity();
-        auto tilepos = QVector3D(tile.second.x, tile.second.y, tile.second.z);
-        model.translate(this->scene->hexcube_to_cartesian(tilepos) + this->scene->get_tile_offset(this->scene->tiledist));
-        mvp = this->scene->projection * this->scene->view * model;
-        mvp.scale(QVector3D(this->scene->tiledist, this->scene->tiledist, 1.0f));
-        model_shader->set_uniform("mvp", mvp);
+    bool valid_highlight = QVector3D::dotProduct(QVector3D(1.0, 1.0, 1.0), tilehighlight) == 0 && !this->scene->flag_dragging;
+    bool highlight = valid_highlight && this->map->get_tile_id(tilehighlight[0], tilehighlight[1]) >= 0;
 
-        QVector3D color;
-        if(this->scene->tile_colors) {
-            color = this->tile_manager->get_color(tile.second.tile_id);
-            if(tilehighlight == tilepos && !this->scene->flag_dragging) {
-                color = 0.50 * color + 0.25 * QVector3D(1.0f, 1.0f, 1.0f);
-                highlight = true;
-            }
-        } else {
-            color = QVector3D(1.0f, 1.0f, 1.0f);
-            if(tilehighlight == tilepos && !this->scene->flag_dragging) {
-                color = 0.75 * color + 0.75 * QVector3D(1.0f, 1.0f, 1.0f);
-                highlight = true;
-            }
-        }
+    // tile colors are baked into the instance data
+    if(this->tile_colors != this->scene->tile_colors) {
+        this->tile_colors = this->scene->tile_colors;
+        this->flag_rebuild = true;
+    }
 
-        model_shader->set_uniform("color", color);
+    // blocks that moved leave their old slots behind, which are reclaimed by
+    // packing the buffer anew once they make up half of it
+    if(this->flag_rebuild || this->wasted_slots > this->instances.size() / 2) {
+        this->rebuild_instances();
+    }
 
-        QVector4D uv = this->tile_manager->get_uv(tile.second.tile_id);
-        std::vector<float> uvs = {uv[0], uv[3], uv[2], uv[3], uv[2], uv[1], uv[0], uv[1]};
-        this->vbo[1].bind();
-        this->vbo[1].allocate(&uvs[0], uvs.size() * sizeof(float));
+    // show an empty tile on the hovered cell when it does not contain a tile
+    TileInstance ghost = {};
+    if(valid_highlight && !highlight) {
+        ghost = this->build_instance(this->template_tile_id, tilehighlight[0], tilehighlight[1], QVector3D(0.05, 0.05, 0.05));
+    }
+    if(std::memcmp(&ghost, &this->instances[0], sizeof(TileInstance)) != 0) {
+        this->instances[0] = ghost;
+        this->dirty_slots.push_back(0);
+    }
 
-        f->glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    // the highlighted tile is brightened in the vertex shader
+    QVector2D highlight_factor(1.0f, 0.0f);
+    if(highlight) {
+        highlight_factor = this->scene->tile_colors ? QVector2D(0.50f, 0.25f) : QVector2D(0.75f, 0.75f);
     }
 
-    if(!highlight && QVector3D::dotProduct(QVector3D(1.0, 1.0, 1.0), tilehighlight) == 0 && !this->scene->flag_dragging) {
-        model.setToIdentity();
-        model.translate(this->scene->hexcube_to_cartesian(tilehighlight) + this->scene->get_tile_offset(this->scene->tiledist));
-        mvp = this->scene->projection * this->scene->view * model;
-        mvp.scale(QVector3D(this->scene->tiledist, this->scene->tiledist, 1.0f));
-        model_shader->set_uniform("mvp", mvp);
+    model_shader->set_uniform("viewprojection", this->scene->projection * this->scene->view);
+    model_shader->set_uniform("hex2cart", this->scene->hex2cart);
+    model_shader->set_uniform("tile_offset", this->scene->get_tile_offset(this->scene->tiledist));
+    model_shader->set_uniform("tile_scale", this->scene->tiledist);
+
+    // the depth of a tile follows its screen row, normalised over the rows
+    // that can appear on the screen
+    const HexRange range = this->get_visible_range(sprite_margin);
+    this->set_depth_range(range.rowmin, range.rowmax);
+
+    this->vao.bind();
+    this->tilespackage->bind();
 
-        QVector3D color = QVector3D(0.05, 0.05, 0.05);
-        model_shader->set_uniform("color", color);
+    this->upload_instances();
 
-        QVector4D uv = this->tile_manager->get_uv(this->tile_manager->get_tile_id("ST00_000"));
-        std::vector<float> uvs = {uv[0], uv[3], uv[2], uv[3], uv[2], uv[1], uv[0], uv[1]};
-        this->vbo[1].bind();
-        this->vbo[1].allocate(&uvs[0], uvs.size() * sizeof(float));
+    // zoomed out, the chunks are drawn as pre-rendered images instead of tiles
+    const bool use_impostors = this->flag_impostors && this->get_tile_pixels() < impostor_threshold;
+    std::vector<std::pair<unsigned int, const MapChunk*>> chunks;
+    this->for_each_visible_chunk([&](unsigned int pos, const MapChunk& chunk) {
+        chunks.emplace_back(pos, &chunk);
+    });
+    if(use_impostors) {
+        this->update_impostors(chunks);
+    }
 
-        f->glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    // the highlight and selection are only set once the impostors are
+    // rendered, as they would otherwise be baked into them
+    model_shader->set_uniform("highlight", QVector2D(tilehighlight[0], tilehighlight[1]));
+    model_shader->set_uniform("highlight_factor", highlight_factor);
+    model_shader->set_uniform("selection", QVector4D(this->selection.xmin, this->selection.xmax,
+                                                     this->selection.rowmin, this->selection.rowmax));
+    model_shader->set_uniform("selection_color", QVector3D(selection_color[0], selection_color[1], selection_color[2]));
+
+    // the opaque texels of all tiles are drawn before their antialiased edges
+    for(unsigned int pass=0; pass<2; pass++) {
+        this->set_alpha_pass(pass == 1);
+
+        // draw the empty tile under the cursor
+        this->set_instance_offset(0);
+        f->glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, 1);
+
+        // only the occupied part of the chunks that overlap the screen is drawn,
+        // such that the cost of a frame does not depend on the size of the map
+        if(!use_impostors) {
+            for(const auto& item : chunks) {
+                this->draw_block(item.first);
+            }
+        }
     }
+    this->set_alpha_pass(false);
 
     this->vao.release();
     this->tilespackage->release();
     model_shader->release();
+
+    if(use_impostors) {
+        this->draw_impostors(std::move(chunks));
+    }
 }
 
 /**
  * @brief      Draw map background
  */
 void MapRenderer::draw_template_map() {
-    // determine hexpositions
-    auto leftbottom = this->scene->get_hexpos_at_mousepos(QPoint(0,0));
-    auto righttop = this->scene->get_hexpos_at_mousepos(QPoint(this->scene->canvas_width,this->scene->canvas_height));
+    // the background covers the visible cells including a margin for the
+    // sprite offsets
+    const HexRange range = this->get_visible_range(1);
+    const int xmin = range.xmin;
+    const int xmax = range.xmax;
+    const int rowmin = range.rowmin;
+    const int rows = (range.rowmax - rowmin) / 2 + 2;
 
     ShaderProgram *model_shader = this->shader_manager->get_shader_program("background_shader");
     model_shader->bind();
 
-    QMatrix4x4 model;
-    model.setToIdentity();
-    QMatrix4x4 mvp = this->scene->projection * this->scene->view * model;
+    model_shader->set_uniform("viewprojection", this->scene->projection * this->scene->view);
+    model_shader->set_uniform("hex2cart", this->scene->hex2cart);
+    model_shader->set_uniform("tile_offset", this->scene->get_tile_offset(this->scene->tiledist));
+    model_shader->set_uniform("tile_scale", this->scene->tiledist);
+    model_shader->set_uniform("uvrect", this->tile_manager->get_uv(this->template_tile_id));
+    model_shader->set_uniform("hex_xmin", xmin);
+    model_shader->set_uniform("hex_rowmin", rowmin);
+    model_shader->set_uniform("hex_rows", rows);
+    model_shader->set_uniform("color", QVector3D(0.058, 0.065, 0.070));
 
-    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
 
-    // draw tile
+    // draw all visible background tiles in a single call; the background never
+    // occludes the tiles
     this->vao.bind();
     this->tilespackage->bind();
+    f->glDepthMask(GL_FALSE);
 
-    for(int y = righttop.y(); y <= leftbottom.y(); y++) {
-        for(int x = leftbottom.x(); x <= righttop.x(); x++) {
-            model.setToIdentity();
-            int z = -(x + y);
-            QVector3D tilepos(x,y,z);
-            model.translate(this->scene->hexcube_to_cartesian(tilepos) + this->scene->get_tile_offset(this->scene->tiledist));
-            mvp = this->scene->projection * this->scene->view * model;
-            mvp.scale(QVector3D(this->scene->tiledist, this->scene->tiledist, 1.0f));
-            model_shader->set_uniform("mvp", mvp);
-
-            QVector3D color = QVector3D(0.058, 0.065, 0.070);
-            model_shader->set_uniform("color", color);
-
-            QVector4D uv = this->tile_manager->get_uv(this->tile_manager->get_tile_id("ST00_000"));
-            std::vector<float> uvs = {uv[0], uv[3], uv[2], uv[3], uv[2], uv[1], uv[0], uv[1]};
-            this->vbo[1].bind();
-            this->vbo[1].allocate(&uvs[0], uvs.size() * sizeof(float));
-
-            f->glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        }
-    }
+    f->glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (xmax - xmin + 1) * rows);
 
+    f->glDepthMask(GL_TRUE);
     this->vao.release();
     this->tilespackage->release();
     model_shader->release();
@@ -185,9 +234,18 @@ void MapRenderer::draw_debug() {
     QVector3D red(1.0, 0.0, 0.0);
     QVector3D green(0.0, 1.0, 0.0);
 
-    for(const auto& tile : this->map->get_tiles()) {
+    const HexRange range = this->get_visible_range(sprite_margin);
+    const int ymin = (int)std::floor((range.rowmin - range.xmax) / 2.0);
+    const int ymax = (int)std::ceil((range.rowmax - range.xmin) / 2.0);
+    this->map->for_each_tile_in(range.xmin, range.xmax, ymin, ymax, [&](const Tile& tile) {
+        // the rectangle also holds tiles above and below the screen
+        const int row = 2 * tile.y + tile.x;
+        if(row < range.rowmin || row > range.rowmax) {
+            return;
+        }
+
         model.setToIdentity();
-        auto tilepos = QVector3D(tile.second.x, tile.second.y, tile.second.z);
+        auto tilepos = QVector3D(tile.x, tile.y, tile.z());
         model.translate(this->scene->hexcube_to_cartesian(tilepos));
         mvp = this->scene->projection * this->scene->view * model;
         mvp.scale(QVector3D(0.1, 0.1, 0.1));
@@ -196,14 +254,13 @@ void MapRenderer::draw_debug() {
         f->glDrawElements(GL_LINE_LOOP, 6, GL_UNSIGNED_INT, 0);     // draw tile center
 
         model.setToIdentity();
-        tilepos = QVector3D(tile.second.x, tile.second.y, tile.second.z);
         model.translate(this->scene->hexcube_to_cartesian(tilepos) + this->scene->get_tile_offset(this->scene->tiledist));
         mvp = this->scene->projection * this->scene->view * model;
         mvp.scale(QVector3D(0.1, 0.1, 0.1));
         model_shader->set_uniform("mvp", mvp);
         model_shader->set_uniform("color", red);
         f->glDrawElements(GL_LINE_LOOP, 6, GL_UNSIGNED_INT, 0);     // draw sprite center
-    }
+    });
 
     this->vao.release();
     model_shader->release();
@@ -226,14 +283,6 @@ void MapRenderer::build_vao() {
     f->glEnableVertexAttribArray(0);
     f->glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
 
-    std::vector<float> uvs = {0.0, 1.0, 1.0, 1.0, 1.0, 0.0, 0.0, 0.0};
-    this->vbo[1].create();
-    this->vbo[1].setUsagePattern(QOpenGLBuffer::DynamicDraw);
-    this->vbo[1].bind();
-    this->vbo[1].allocate(&uvs[0], uvs.size() * sizeof(float));
-    f->glEnableVertexAttribArray(1);
-    f->glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
     std::vector<unsigned int> indices = {0,1,3,1,2,3};
     this->vbo[2] = QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
     this->vbo[2].create();
@@ -241,5 +290,641 @@ void MapRenderer::build_vao() {
     this->vbo[2].bind();
     this->vbo[2].allocate(&indices[0], 6 * sizeof(unsigned int));
 
+    // per-instance tile data
+    QOpenGLExtraFunctions *ef = QOpenGLContext::currentContext()->extraFunctions();
+    TileInstance empty = {};
+    this->vbo[1].create();
+    this->vbo[1].setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    this->vbo[1].bind();
+    this->vbo[1].allocate(&empty, sizeof(TileInstance));
+    f->glEnableVertexAttribArray(2);
+    f->glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(TileInstance), (void*)offsetof(TileInstance, hexpos));
+    ef->glVertexAttribDivisor(2, 1);
+    f->glEnableVertexAttribArray(3);
+    f->glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(TileInstance), (void*)offsetof(TileInstance, uv));
+    ef->glVertexAttribDivisor(3, 1);
+    f->glEnableVertexAttribArray(4);
+    f->glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(TileInstance), (void*)offsetof(TileInstance, color));
+    ef->glVertexAttribDivisor(4, 1);
+
     this->vao.release();
 }
+
+/**
+ * @brief      Get the range of cells that are visible on the screen
+ *
+ * @param[in]  margin  Number of additional columns and rows on each side
+ *
+ * @return     The visible range
+ */
+MapRenderer::HexRange MapRenderer::get_visible_range(int margin) const {
+    // determine the range of visible columns and screen rows (2y + x) from the
+    // corners of the screen
+    auto leftbottom = this->scene->get_hexpos_at_mousepos(QPoint(0,0));
+    auto righttop = this->scene->get_hexpos_at_mousepos(QPoint(this->scene->canvas_width,this->scene->canvas_height));
+    const int row1 = (int)(2 * leftbottom.y() + leftbottom.x());
+    const int row2 = (int)(2 * righttop.y() + righttop.x());
+
+    HexRange range;
+    range.xmin = (int)std::min(leftbottom.x(), righttop.x()) - margin;
+    range.xmax = (int)std::max(leftbottom.x(), righttop.x()) + margin;
+    range.rowmin = std::min(row1, row2) - 1 - margin;
+    range.rowmax = std::max(row1, row2) + 1 + margin;
+    return range;
+}
+
+/**
+ * @brief      Render the impostors of chunks that are missing or changed;
+ *             requires the sprite shader and the vertex array to be bound
+ *
+ * @param[in]  chunks  The chunks and their positions
+ */
+void MapRenderer::update_impostors(const std::vector<std::pair<unsigned int, const MapChunk*>>& chunks) {
+    if(this->impostors.size() < this->map->get_nr_chunks()) {
+        this->impostors.resize(this->map->get_nr_chunks());
+    }
+
+    // the impostors are rendered in between the passes of the frame, hence
+    // the state of the frame is restored afterwards
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    GLint framebuffer = 0;
+    GLint viewport[4];
+    GLint blend[4];
+    GLfloat clear_color[4];
+    bool saved = false;
+
+    for(const auto& item : chunks) {
+        const ChunkImpostor& impostor = this->impostors[item.first];
+        if(impostor.fbo && !impostor.dirty) {
+            continue;
+        }
+
+        if(!saved) {
+            f->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+            f->glGetIntegerv(GL_VIEWPORT, viewport);
+            f->glGetIntegerv(GL_BLEND_SRC_RGB, &blend[0]);
+            f->glGetIntegerv(GL_BLEND_DST_RGB, &blend[1]);
+            f->glGetIntegerv(GL_BLEND_SRC_ALPHA, &blend[2]);
+            f->glGetIntegerv(GL_BLEND_DST_ALPHA, &blend[3]);
+            f->glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color);
+
+            // colors are accumulated premultiplied by alpha onto a transparent background
+            f->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            f->glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+            // impostors are cached, hence neither the tile under the cursor
+            // nor the selection is drawn into them
+            ShaderProgram *model_shader = this->shader_manager->get_shader_program("sprite_shader");
+            model_shader->set_uniform("highlight_factor", QVector2D(1.0f, 0.0f));
+            model_shader->set_uniform("selection", QVector4D(1.0f, 0.0f, 1.0f, 0.0f));
+            saved = true;
+        }
+
+        this->render_impostor(item.first, *item.second);
+    }
+
+    if(saved) {
+        f->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        f->glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        f->glBlendFuncSeparate(blend[0], blend[1], blend[2], blend[3]);
+        f->glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+
+        // restore the view projection and depth range of the frame
+        ShaderProgram *model_shader = this->shader_manager->get_shader_program("sprite_shader");
+        model_shader->set_uniform("viewprojection", this->scene->projection * this->scene->view);
+        const HexRange range = this->get_visible_range(sprite_margin);
+        this->set_depth_range(range.rowmin, range.rowmax);
+    }
+}
+
+/**
+ * @brief      Render all tiles of a chunk into its impostor
+ *
+ * @param[in]  pos    Position of the chunk
+ * @param[in]  chunk  The chunk
+ */
+void MapRenderer::render_impostor(unsigned int pos, const MapChunk& chunk) {
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    ChunkImpostor& impostor = this->impostors[pos];
+
+    // the area covers the sprites of the corner cells of the chunk
+    const QVector3D offset = this->scene->get_tile_offset(this->scene->tiledist);
+    const float margin = this->scene->tiledist / 2.0f;
+    float xmin = std::numeric_limits<float>::max();
+    float ymin = std::numeric_limits<float>::max();
+    float xmax = -std::numeric_limits<float>::max();
+    float ymax = -std::numeric_limits<float>::max();
+    for(unsigned int i=0; i<4; i++) {
+        const int x = chunk.cx * CHUNK_SIZE + (i & 1) * (CHUNK_SIZE - 1);
+        const int y = chunk.cy * CHUNK_SIZE + (i >> 1) * (CHUNK_SIZE - 1);
+        const QVector3D center = this->scene->hexcube_to_cartesian(QVector3D(x, y, -(x + y))) + offset;
+        xmin = std::min(xmin, center.x() - margin);
+        xmax = std::max(xmax, center.x() + margin);
+        ymin = std::min(ymin, center.y() - margin);
+        ymax = std::max(ymax, center.y() + margin);
+    }
+    impostor.rect = QVector4D(xmin, ymin, xmax, ymax);
+
+    // all chunks have the same size, hence the framebuffer is kept once created
+    const float pixels_per_unit = impostor_tile_pixels / this->scene->tiledist;
+    const QSize size((int)std::ceil((xmax - xmin) * pixels_per_unit), (int)std::ceil((ymax - ymin) * pixels_per_unit));
+    if(!impostor.fbo || impostor.fbo->size() != size) {
+        if(impostor.fbo) {
+            this->impostor_bytes -= get_impostor_bytes(impostor.fbo->size());
+        }
+        impostor.fbo = std::make_unique<QOpenGLFramebufferObject>(size, QOpenGLFramebufferObject::NoAttachment);
+        this->impostor_bytes += get_impostor_bytes(size);
+
+        // an impostor covers many pixels per texel once zoomed out further
+        f->glBindTexture(GL_TEXTURE_2D, impostor.fbo->texture());
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // the depth is kept in a texture such that the impostors can be
+        // layered per texel instead of per chunk
+        impostor.depth = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+        impostor.depth->setFormat(QOpenGLTexture::D24);
+        impostor.depth->setSize(size.width(), size.height());
+        impostor.depth->setMipLevels(1);
+        impostor.depth->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+        impostor.depth->setWrapMode(QOpenGLTexture::ClampToEdge);
+        impostor.depth->allocateStorage(QOpenGLTexture::Depth, QOpenGLTexture::UInt32);
+        impostor.fbo->bind();
+        f->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, impostor.depth->textureId(), 0);
+        this->tilespackage->bind();
+    }
+
+    impostor.fbo->bind();
+    f->glViewport(0, 0, size.width(), size.height());
+    f->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    ShaderProgram *model_shader = this->shader_manager->get_shader_program("sprite_shader");
+    model_shader->set_uniform("viewprojection", this->get_impostor_viewprojection(impostor.rect));
+
+    // the cells of the chunk cover 3 * (CHUNK_SIZE - 1) + 1 screen rows
+    const int rowmin = 2 * chunk.cy * CHUNK_SIZE + chunk.cx * CHUNK_SIZE;
+    impostor.rows = QVector2D(rowmin, rowmin + 3 * (CHUNK_SIZE - 1));
+    this->set_depth_range(impostor.rows[0], impostor.rows[1]);
+
+    // the edges also write their depth, such that every texel that is drawn
+    // from the impostor has a depth; only overlapping edges are affected
+    this->set_alpha_pass(false);
+    this->draw_block(pos);
+    this->set_alpha_pass(true);
+    f->glDepthMask(GL_TRUE);
+    this->draw_block(pos);
+    this->set_alpha_pass(false);
+
+    f->glBindTexture(GL_TEXTURE_2D, impostor.fbo->texture());
+    f->glGenerateMipmap(GL_TEXTURE_2D);
+    this->tilespackage->bind();
+
+    impostor.dirty = false;
+}
+
+/**
+ * @brief      Draw the impostors of chunks from back to front
+ *
+ * @param[in]  chunks  The chunks and their positions
+ */
+void MapRenderer::draw_impostors(std::vector<std::pair<unsigned int, const MapChunk*>> chunks) {
+    this->frame_counter++;
+
+    // the impostors write the depth of their tiles, such that sprites that
+    // overlap a neighbouring chunk are layered per texel; the chunks are
+    // still drawn back to front for the blended edges
+    std::sort(chunks.begin(), chunks.end(), [](const auto& a, const auto& b) {
+        return 2 * a.second->cy + a.second->cx > 2 * b.second->cy + b.second->cx;
+    });
+
+    ShaderProgram *impostor_shader = this->shader_manager->get_shader_program("impostor_shader");
+    impostor_shader->bind();
+    impostor_shader->set_uniform("viewprojection", this->scene->projection * this->scene->view);
+    impostor_shader->set_uniform("selection_rect", this->get_selection_rect());
+    impostor_shader->set_uniform("selection_color", QVector3D(selection_color[0], selection_color[1], selection_color[2]));
+    impostor_shader->set_uniform("tex", 0);
+    impostor_shader->set_uniform("depthtex", 1);
+
+    // the same rows are spread over the depth range as for the tiles
+    const HexRange range = this->get_visible_range(sprite_margin);
+    impostor_shader->set_uniform("depth_range", QVector2D(range.rowmin, std::max(range.rowmax, range.rowmin + 1)));
+
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    this->vao.bind();
+
+    // the opaque texels of all impostors are drawn before their edges
+    for(unsigned int pass=0; pass<2; pass++) {
+        if(pass == 0) {
+            impostor_shader->set_uniform("alpha_range", QVector2D(opaque_alpha, 1.0f));
+            f->glDepthMask(GL_TRUE);
+        } else {
+            impostor_shader->set_uniform("alpha_range", QVector2D(min_alpha, opaque_alpha));
+            f->glDepthMask(GL_FALSE);
+        }
+
+        for(const auto& item : chunks) {
+            ChunkImpostor& impostor = this->impostors[item.first];
+            impostor.last_used = this->frame_counter;
+            impostor_shader->set_uniform("rect", impostor.rect);
+            impostor_shader->set_uniform("rows", impostor.rows);
+            impostor_shader->set_uniform("impostor_viewprojection", this->get_impostor_viewprojection(impostor.rect));
+            f->glActiveTexture(GL_TEXTURE1);
+            impostor.depth->bind();
+            f->glActiveTexture(GL_TEXTURE0);
+            f->glBindTexture(GL_TEXTURE_2D, impostor.fbo->texture());
+            f->glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        }
+    }
+
+    f->glActiveTexture(GL_TEXTURE1);
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+    f->glActiveTexture(GL_TEXTURE0);
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+    f->glDepthMask(GL_TRUE);
+    this->vao.release();
+    impostor_shader->release();
+
+    this->evict_impostors();
+}
+
+/**
+ * @brief      Free the least recently used impostors until the memory
+ *             budget is met
+ */
+void MapRenderer::evict_impostors() {
+    while(this->impostor_bytes > max_impostor_bytes) {
+        ChunkImpostor* oldest = nullptr;
+        for(auto& impostor : this->impostors) {
+            if(impostor.fbo && impostor.last_used != this->frame_counter &&
+               (oldest == nullptr || impostor.last_used < oldest->last_used)) {
+                oldest = &impostor;
+            }
+        }
+
+        // impostors that are on screen are never freed
+        if(oldest == nullptr) {
+            return;
+        }
+
+        this->impostor_bytes -= get_impostor_bytes(oldest->fbo->size());
+        oldest->fbo.reset();
+        oldest->depth.reset();
+        oldest->dirty = true;
+    }
+}
+
+/**
+ * @brief      Get the projection of an impostor, which maps its area in
+ *             world space onto the complete texture
+ *
+ * @param[in]  rect  The area in world space
+ *
+ * @return     The view projection matrix
+ */
+QMatrix4x4 MapRenderer::get_impostor_viewprojection(const QVector4D& rect) const {
+    // look at the area in the same way as the camera of the scene
+    const QVector3D center((rect[0] + rect[2]) / 2.0f, (rect[1] + rect[3]) / 2.0f, 0.0f);
+    const float half_width = (rect[2] - rect[0]) / 2.0f;
+    const float half_height = (rect[3] - rect[1]) / 2.0f;
+
+    QMatrix4x4 view;
+    view.lookAt(center + QVector3D(0.0f, 0.0f, 10.0f), center, QVector3D(0.0, -1.0, 0.0));
+    QMatrix4x4 projection;
+    projection.ortho(-half_width, half_width, -half_height, half_height, 0.01f, 1000.0f);
+    return projection * view;
+}
+
+/**
+ * @brief      Get the area of the selection in world space, covering the
+ *             sprites of the selected cells
+ *
+ * @return     The area (xmin, ymin, xmax, ymax), empty without selection
+ */
+QVector4D MapRenderer::get_selection_rect() const {
+    if(this->selection.xmin > this->selection.xmax) {
+        return QVector4D(1.0f, 1.0f, 0.0f, 0.0f);
+    }
+
+    // the rectangle is aligned with the screen, hence its corners suffice
+    const QVector3D offset = this->scene->get_tile_offset(this->scene->tiledist);
+    const float margin = this->scene->tiledist / 2.0f;
+    float xmin = std::numeric_limits<float>::max();
+    float ymin = std::numeric_limits<float>::max();
+    float xmax = -std::numeric_limits<float>::max();
+    float ymax = -std::numeric_limits<float>::max();
+    for(unsigned int i=0; i<4; i++) {
+        const float x = (i & 1) ? this->selection.xmax : this->selection.xmin;
+        const float row = (i >> 1) ? this->selection.rowmax : this->selection.rowmin;
+        const float y = (row - x) / 2.0f;
+        const QVector3D center = this->scene->hexcube_to_cartesian(QVector3D(x, y, -(x + y))) + offset;
+        xmin = std::min(xmin, center.x() - margin);
+        xmax = std::max(xmax, center.x() + margin);
+        ymin = std::min(ymin, center.y() - margin);
+        ymax = std::max(ymax, center.y() + margin);
+    }
+    return QVector4D(xmin, ymin, xmax, ymax);
+}
+
+/**
+ * @brief      Draw the tiles of a chunk; requires the sprite shader and the
+ *             vertex array to be bound
+ *
+ * @param[in]  pos   Position of the chunk
+ */
+void MapRenderer::draw_block(unsigned int pos) {
+    const InstanceBlock& block = this->blocks[pos];
+    if(block.used == 0) {
+        return;
+    }
+
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    this->set_instance_offset(block.base);
+    f->glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, block.used);
+}
+
+/**
+ * @brief      Select which texels of the sprites are drawn; opaque texels
+ *             write depth such that the draw order of the tiles does not
+ *             matter, whereas the partially transparent edges are blended
+ *             over them without occluding anything
+ *
+ * @param[in]  edges  Whether to draw the edges instead of the opaque texels
+ */
+void MapRenderer::set_alpha_pass(bool edges) {
+    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    ShaderProgram *model_shader = this->shader_manager->get_shader_program("sprite_shader");
+    if(edges) {
+        model_shader->set_uniform("alpha_range", QVector2D(min_alpha, opaque_alpha));
+        f->glDepthMask(GL_FALSE);
+    } else {
+        model_shader->set_uniform("alpha_range", QVector2D(opaque_alpha, 1.0f));
+        f->glDepthMask(GL_TRUE);
+    }
+}
+
+/**
+ * @brief      Set the range of screen rows (2y + x) that is mapped onto the
+ *             depth range; requires the sprite shader to be bound
+ *
+ * @param[in]  rowmin  The row in front
+ * @param[in]  rowmax  The row in the back
+ */
+void MapRenderer::set_depth_range(int rowmin, int rowmax) {
+    ShaderProgram *model_shader = this->shader_manager->get_shader_program("sprite_shader");
+    model_shader->set_uniform("depth_range", QVector2D(rowmin, std::max(rowmax, rowmin + 1)));
+}
+
+/**
+ * @brief      Point the instance attributes at a slot of the instance
+ *             buffer, which becomes instance 0 of the next draw call
+ *
+ * @param[in]  slot  The slot
+ */
+void MapRenderer::set_instance_offset(size_t slot) {
+    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    const size_t offset = slot * sizeof(TileInstance);
+
+    // OpenGL 3.3 lacks a base instance for instanced draws
+    this->vbo[1].bind();
+    f->glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(TileInstance), (void*)(offset + offsetof(TileInstance, hexpos)));
+    f->glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(TileInstance), (void*)(offset + offsetof(TileInstance, uv)));
+    f->glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(TileInstance), (void*)(offset + offsetof(TileInstance, color)));
+}
+
+/**
+ * @brief      Build the instance data of a single tile
+ *
+ * @param[in]  tile_id  The tile identifier
+ * @param[in]  x        x coordinate
+ * @param[in]  y        y coordinate
+ * @param[in]  color    The tile color
+ *
+ * @return     The tile instance.
+ */
+TileInstance MapRenderer::build_instance(unsigned int tile_id, int x, int y, const QVector3D& color) const {
+    const QVector4D& uv = this->tile_manager->get_uv(tile_id);
+    return TileInstance{
+        {(float)x, (float)y},
+        {uv[0], uv[1], uv[2], uv[3]},
+        {color[0], color[1], color[2], 1.0f}
+    };
+}
+
+/**
+ * @brief      Sets the map.
+ *
+ * @param[in]  _map  The map
+ */
+void MapRenderer::set_map(const std::shared_ptr<Map>& _map) {
+    if(this->map) {
+        this->map->remove_listener(this->listener_handle);
+    }
+
+    this->map = _map;
+    this->listener_handle = this->map->add_listener([this](MapEvent event, int x, int y) {
+        this->update_instance(event, x, y);
+    });
+    this->flag_rebuild = true;
+}
+
+/**
+ * @brief      Mark the cells within a screen aligned rectangle as
+ *             selected, such that they are drawn tinted
+ *
+ * @param[in]  from  Hexcube coordinates of the first corner
+ * @param[in]  to    Hexcube coordinates of the second corner
+ */
+void MapRenderer::set_selection(const QVector3D& from, const QVector3D& to) {
+    // same columns and screen rows as MapRegion::rectangle
+    const int row1 = 2 * (int)from[1] + (int)from[0];
+    const int row2 = 2 * (int)to[1] + (int)to[0];
+    this->selection.xmin = std::min((int)from[0], (int)to[0]);
+    this->selection.xmax = std::max((int)from[0], (int)to[0]);
+    this->selection.rowmin = std::min(row1, row2);
+    this->selection.rowmax = std::max(row1, row2);
+}
+
+/**
+ * @brief      Build the instance data of the tile on the map at a coordinate
+ *
+ * @param[in]  x     x coordinate
+ * @param[in]  y     y coordinate
+ *
+ * @return     The tile instance.
+ */
+TileInstance MapRenderer::build_map_instance(int x, int y) const {
+    unsigned int tile_id = this->map->get_tile_id(x, y);
+    QVector3D color(1.0f, 1.0f, 1.0f);
+    if(this->tile_colors) {
+        color = this->tile_manager->get_color(tile_id);
+    }
+    return this->build_instance(tile_id, x, y, color);
+}
+
+/**
+ * @brief      Update the instance buffer after a modification of the map
+ *
+ * @param[in]  event  The event
+ * @param[in]  x      x coordinate
+ * @param[in]  y      y coordinate
+ */
+void MapRenderer::update_instance(MapEvent event, int x, int y) {
+    // the complete buffer is going to be rebuilt anyway
+    if(this->flag_rebuild) {
+        return;
+    }
+
+    // a new chunk starts with an empty block
+    const unsigned int pos = this->map->find_chunk(x, y);
+    if(pos < this->impostors.size()) {
+        this->impostors[pos].dirty = true;
+    }
+    if(pos >= this->blocks.size()) {
+        this->blocks.resize(pos + 1);
+    }
+
+    const unsigned int i = Map::local_index(x, y);
+    if(event == MapEvent::Inserted) {
+        const unsigned int local = this->allocate_slot(pos);
+        this->blocks[pos].slot_of[i] = local;
+    }
+
+    InstanceBlock& block = this->blocks[pos];
+    const size_t slot = block.base + block.slot_of[i];
+    switch(event) {
+        case MapEvent::Inserted:
+        case MapEvent::Substituted:
+            this->instances[slot] = this->build_map_instance(x, y);
+        break;
+        case MapEvent::Removed:
+            this->instances[slot] = TileInstance{};
+            block.free_slots.push_back(block.slot_of[i]);
+        break;
+    }
+    this->dirty_slots.push_back(slot);
+}
+
+/**
+ * @brief      Hand out a slot in the block of a chunk, growing the block
+ *             when it is full
+ *
+ * @param[in]  pos   Position of the chunk
+ *
+ * @return     The slot relative to the base of the block
+ */
+unsigned int MapRenderer::allocate_slot(unsigned int pos) {
+    InstanceBlock& block = this->blocks[pos];
+    if(!block.free_slots.empty()) {
+        const unsigned int local = block.free_slots.back();
+        block.free_slots.pop_back();
+        return local;
+    }
+
+    // free slots are reused first, hence a block never exceeds the size of a chunk
+    if(block.used == block.capacity) {
+        this->grow_block(pos);
+    }
+    return block.used++;
+}
+
+/**
+ * @brief      Double the capacity of the block of a chunk
+ *
+ * @param[in]  pos   Position of the chunk
+ */
+void MapRenderer::grow_block(unsigned int pos) {
+    InstanceBlock& block = this->blocks[pos];
+    const unsigned int capacity = block.capacity == 0 ? min_block_slots :
+                                  std::min<unsigned int>(2 * block.capacity, CHUNK_SIZE * CHUNK_SIZE);
+    if(block.slot_of.empty()) {
+        block.slot_of.resize(CHUNK_SIZE * CHUNK_SIZE, 0);
+    }
+
+    // the last block of the buffer grows in place, any other block moves to
+    // the end of the buffer and leaves its old slots unused
+    if(block.base + block.capacity != this->instances.size()) {
+        const size_t base = this->instances.size();
+        this->instances.resize(base + capacity, TileInstance{});
+        std::copy(this->instances.begin() + block.base, this->instances.begin() + block.base + block.used,
+                  this->instances.begin() + base);
+        for(unsigned int i=0; i<block.used; i++) {
+            this->dirty_slots.push_back(base + i);
+        }
+        this->wasted_slots += block.capacity;
+        block.base = base;
+    } else {
+        this->instances.resize(block.base + capacity, TileInstance{});
+    }
+    block.capacity = capacity;
+}
+
+/**
+ * @brief      Rebuild the complete instance buffer from the map
+ */
+void MapRenderer::rebuild_instances() {
+    this->dirty_slots.clear();
+    this->impostors.clear();
+    this->impostor_bytes = 0;
+
+    // pack the blocks back to back, each rounded up to a power of two slots
+    // such that a chunk can grow a little before its block has to move
+    this->blocks.assign(this->map->get_nr_chunks(), InstanceBlock{});
+    size_t nr_slots = 1;
+    for(unsigned int pos=0; pos<this->blocks.size(); pos++) {
+        const unsigned int count = this->map->get_chunk(pos).count;
+        if(count == 0) {
+            continue;
+        }
+        InstanceBlock& block = this->blocks[pos];
+        block.capacity = min_block_slots;
+        while(block.capacity < count) {
+            block.capacity *= 2;
+        }
+        block.base = nr_slots;
+        block.slot_of.resize(CHUNK_SIZE * CHUNK_SIZE, 0);
+        nr_slots += block.capacity;
+    }
+
+    this->instances.assign(nr_slots, TileInstance{});
+    this->map->for_each_tile([this](const Tile& tile) {
+        InstanceBlock& block = this->blocks[this->map->find_chunk(tile.x, tile.y)];
+        block.slot_of[Map::local_index(tile.x, tile.y)] = block.used;
+        this->instances[block.base + block.used++] = this->build_map_instance(tile.x, tile.y);
+    });
+    this->wasted_slots = 0;
+
+    // force a complete upload
+    this->gpu_capacity = 0;
+    this->flag_rebuild = false;
+}
+
+/**
+ * @brief      Transfer all modified instances to the GPU
+ */
+void MapRenderer::upload_instances() {
+    this->vbo[1].bind();
+
+    // grow the buffer geometrically and transfer everything when it is too small
+    if(this->instances.size() > this->gpu_capacity) {
+        this->gpu_capacity = std::max<size_t>(this->instances.size() * 3 / 2, 64);
+        this->vbo[1].allocate(this->gpu_capacity * sizeof(TileInstance));
+        this->vbo[1].write(0, &this->instances[0], this->instances.size() * sizeof(TileInstance));
+        this->dirty_slots.clear();
+        return;
+    }
+
+    // only transfer the modified slots, merging consecutive slots into a single transfer
+    std::sort(this->dirty_slots.begin(), this->dirty_slots.end());
+    this->dirty_slots.erase(std::unique(this->dirty_slots.begin(), this->dirty_slots.end()), this->dirty_slots.end());
+    for(size_t i=0; i<this->dirty_slots.size(); ) {
+        size_t j = i + 1;
+        while(j < this->dirty_slots.size() && this->dirty_slots[j] == this->dirty_slots[j-1] + 1) {
+            j++;
+        }
+        this->vbo[1].write(this->dirty_slots[i] * sizeof(TileInstance),
+                           &this->instances[this->dirty_slots[i]],
+                           (j - i) * sizeof(TileInstance));
+        i = j;
+    }
+    this->dirty_slots.clear();
+}
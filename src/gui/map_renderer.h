@@ -22,18 +22,65 @@
 #pragma once
 
 #include <QOpenGLFunctions>
+#include <QOpenGLExtraFunctions>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLBuffer>
 #include <QDebug>
 #include <QMatrix4x4>
+#include <QVector2D>
 #include <QtMath>
 #include <QOpenGLTexture>
+#include <QOpenGLFramebufferObject>
+
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <memory>
+#include <limits>
 
 #include "shader_program_manager.h"
 #include "scene.h"
 #include "../data/tile_manager.h"
 #include "../data/map.h"
 
+/**
+ * @brief      Per-instance data of a single tile sprite
+ */
+struct TileInstance {
+    float hexpos[2];    // axial coordinates of the tile
+    float uv[4];        // rectangle in the tile atlas (uvx1, uvy1, uvx2, uvy2)
+    float color[4];     // tile color, a zero alpha hides the instance
+};
+
+/**
+ * @brief      Pre-rendered image of all tiles of a chunk, which replaces the
+ *             individual tiles when the map is zoomed out
+ */
+struct ChunkImpostor {
+    std::unique_ptr<QOpenGLFramebufferObject> fbo;
+    std::unique_ptr<QOpenGLTexture> depth;  // depth of the tiles, sampled when drawn
+    QVector4D rect;                 // area in world space (xmin, ymin, xmax, ymax)
+    QVector2D rows;                 // screen rows spread over the depth of the impostor
+    bool dirty = true;              // whether the chunk changed since it was rendered
+    unsigned int last_used = 0;     // frame in which the impostor was last drawn
+};
+
+/**
+ * @brief      Range of the instance buffer holding the tiles of a chunk; the
+ *             tiles are packed at the start of the range and the slots of
+ *             removed tiles are reused
+ */
+struct InstanceBlock {
+    size_t base = 0;                        // first slot of the block
+    unsigned int capacity = 0;              // number of slots reserved for the chunk
+    unsigned int used = 0;                  // number of slots handed out, including free ones
+    std::vector<unsigned int> free_slots;   // slots of removed tiles, relative to base
+    std::vector<uint16_t> slot_of;          // slot relative to base, indexed by local (x,y)
+};
+
 class MapRenderer {
 private:
     std::shared_ptr<ShaderProgramManager> shader_manager;
@@ -48,6 +95,57 @@ private:
 
     std::shared_ptr<Map> map;
 
+    // persistent instance buffer; slot 0 is reserved for the empty tile under
+    // the cursor and is followed by a block of slots for every chunk of the
+    // map, such that the visible chunks can be drawn without visiting the
+    // other tiles
+    std::vector<TileInstance> instances;    // copy of the instance data on the GPU
+    std::vector<InstanceBlock> blocks;      // indexed by chunk position
+    std::vector<unsigned int> dirty_slots;  // slots that need to be uploaded
+    size_t wasted_slots = 0;                // slots left behind by blocks that moved
+    size_t gpu_capacity = 0;                // number of instances allocated on the GPU
+    bool flag_rebuild = true;               // whether the instance buffer needs to be rebuilt
+    bool tile_colors = true;                // color mode the instance buffer was built with
+
+    unsigned int listener_handle = 0;
+    unsigned int template_tile_id;          // tile id of the empty template tile
+
+    // blocks start at min_block_slots slots and double when full; a full
+    // block that is not at the end of the buffer moves to the end
+    static constexpr unsigned int min_block_slots = 16;
+
+    // level of detail; below impostor_threshold pixels per tile the chunks
+    // are drawn as impostors, which are rendered at impostor_tile_pixels per
+    // tile and are evicted least recently used beyond max_impostor_bytes
+    std::vector<ChunkImpostor> impostors;   // indexed by chunk position
+    size_t impostor_bytes = 0;              // memory held by the impostors
+    unsigned int frame_counter = 0;
+    bool flag_impostors = true;             // whether impostors may be used
+    static constexpr float impostor_threshold = 12.0f;
+    static constexpr float impostor_tile_pixels = 12.0f;
+    static constexpr size_t max_impostor_bytes = 256 << 20;
+
+    // texels with an alpha above opaque_alpha are drawn with depth writes, the
+    // texels between min_alpha and opaque_alpha are blended over them
+    static constexpr float opaque_alpha = 0.99f;
+    static constexpr float min_alpha = 1.0f / 255.0f;
+
+    // number of rows and columns beyond the visible area in which tiles are
+    // still drawn, as sprites extend beyond the cell of their tile
+    static constexpr int sprite_margin = 2;
+
+    /**
+     * @brief      Range of cells covering the screen, as columns (x) and
+     *             screen rows (2y + x)
+     */
+    struct HexRange {
+        int xmin, xmax;
+        int rowmin, rowmax;
+    };
+
+    HexRange selection = {1, 0, 1, 0};      // selected cells, empty when xmin > xmax
+    static constexpr float selection_color[3] = {0.25f, 0.55f, 1.0f};
+
 public:
     /**
      * @brief      Constructs a new instance.
@@ -61,10 +159,21 @@ public:
                 const std::shared_ptr<TileManager>& _tile_manager);
 
     /**
-     * @brief      Draw the actual tiles
+     * @brief      Destroys the object; the OpenGL context in which the
+     *             renderer was created has to be current
+     */
+    ~MapRenderer();
+
+    /**
+     * @brief      Draw the background and the tiles
      */
     void draw();
 
+    /**
+     * @brief      Draw the tiles of the map without the background
+     */
+    void draw_tiles();
+
     /**
      * @brief      Draw map background
      */
@@ -80,13 +189,224 @@ public:
      *
      * @param[in]  _map  The map
      */
-    inline void set_map(const std::shared_ptr<Map>& _map) {
-        this->map = _map;
+    void set_map(const std::shared_ptr<Map>& _map);
+
+    /**
+     * @brief      Set whether zoomed out chunks may be drawn as impostors;
+     *             without impostors all tiles are always drawn
+     *
+     * @param[in]  _flag_impostors  Whether impostors may be used
+     */
+    inline void set_impostors_enabled(bool _flag_impostors) {
+        this->flag_impostors = _flag_impostors;
     }
 
+    /**
+     * @brief      Mark the cells within a screen aligned rectangle as
+     *             selected, such that they are drawn tinted
+     *
+     * @param[in]  from  Hexcube coordinates of the first corner
+     * @param[in]  to    Hexcube coordinates of the second corner
+     */
+    void set_selection(const QVector3D& from, const QVector3D& to);
+
 private:
     /**
      * @brief      Build vertex array objects
      */
     void build_vao();
+
+    /**
+     * @brief      Get the range of cells that are visible on the screen
+     *
+     * @param[in]  margin  Number of additional columns and rows on each side
+     *
+     * @return     The visible range
+     */
+    HexRange get_visible_range(int margin) const;
+
+    /**
+     * @brief      Visit the chunks of the map that are (partially) visible
+     *
+     * @param[in]  f     Function accepting the position of the chunk and a
+     *                   const MapChunk&
+     */
+    template <typename Function>
+    void for_each_visible_chunk(Function f) const {
+        // a screen row (2y + x) range translates into a y range that shifts
+        // with x, hence the range is determined per column of chunks from
+        // the x span of that column only
+        const HexRange range = this->get_visible_range(sprite_margin);
+        for(int cx = range.xmin >> CHUNK_BITS; cx <= range.xmax >> CHUNK_BITS; cx++) {
+            const int xmin = std::max(range.xmin, cx * CHUNK_SIZE);
+            const int xmax = std::min(range.xmax, cx * CHUNK_SIZE + CHUNK_SIZE - 1);
+            const int ymin = (int)std::floor((range.rowmin - xmax) / 2.0);
+            const int ymax = (int)std::ceil((range.rowmax - xmin) / 2.0);
+            this->map->for_each_chunk_in(xmin, xmax, ymin, ymax, f);
+        }
+    }
+
+    /**
+     * @brief      Get the width of a tile on the screen in pixels
+     *
+     * @return     The width of a tile
+     */
+    inline float get_tile_pixels() const {
+        // the projection of the scene may mirror the x axis
+        return std::fabs(this->scene->projection(0,0)) * this->scene->canvas_width / 2.0f * this->scene->tiledist;
+    }
+
+    /**
+     * @brief      Render the impostors of chunks that are missing or changed;
+     *             requires the sprite shader and the vertex array to be bound
+     *
+     * @param[in]  chunks  The chunks and their positions
+     */
+    void update_impostors(const std::vector<std::pair<unsigned int, const MapChunk*>>& chunks);
+
+    /**
+     * @brief      Render all tiles of a chunk into its impostor
+     *
+     * @param[in]  pos    Position of the chunk
+     * @param[in]  chunk  The chunk
+     */
+    void render_impostor(unsigned int pos, const MapChunk& chunk);
+
+    /**
+     * @brief      Get the memory held by an impostor, i.e. its color texture
+     *             with mipmaps and its depth texture
+     *
+     * @param[in]  size  The size of the impostor in pixels
+     *
+     * @return     The number of bytes
+     */
+    static inline size_t get_impostor_bytes(const QSize& size) {
+        const size_t pixels = (size_t)size.width() * size.height();
+        return pixels * 4 * 4 / 3 + pixels * 4;
+    }
+
+    /**
+     * @brief      Draw the impostors of chunks from back to front, using the
+     *             depth of their tiles
+     *
+     * @param[in]  chunks  The chunks and their positions
+     */
+    void draw_impostors(std::vector<std::pair<unsigned int, const MapChunk*>> chunks);
+
+    /**
+     * @brief      Free the least recently used impostors until the memory
+     *             budget is met
+     */
+    void evict_impostors();
+
+    /**
+     * @brief      Get the projection of an impostor, which maps its area in
+     *             world space onto the complete texture
+     *
+     * @param[in]  rect  The area in world space
+     *
+     * @return     The view projection matrix
+     */
+    QMatrix4x4 get_impostor_viewprojection(const QVector4D& rect) const;
+
+    /**
+     * @brief      Get the area of the selection in world space, covering the
+     *             sprites of the selected cells
+     *
+     * @return     The area (xmin, ymin, xmax, ymax), empty without selection
+     */
+    QVector4D get_selection_rect() const;
+
+    /**
+     * @brief      Point the instance attributes at a slot of the instance
+     *             buffer, which becomes instance 0 of the next draw call
+     *
+     * @param[in]  slot  The slot
+     */
+    void set_instance_offset(size_t slot);
+
+    /**
+     * @brief      Draw the tiles of a chunk; requires the sprite shader and the
+     *             vertex array to be bound
+     *
+     * @param[in]  pos   Position of the chunk
+     */
+    void draw_block(unsigned int pos);
+
+    /**
+     * @brief      Hand out a slot in the block of a chunk, growing the block
+     *             when it is full
+     *
+     * @param[in]  pos   Position of the chunk
+     *
+     * @return     The slot relative to the base of the block
+     */
+    unsigned int allocate_slot(unsigned int pos);
+
+    /**
+     * @brief      Double the capacity of the block of a chunk
+     *
+     * @param[in]  pos   Position of the chunk
+     */
+    void grow_block(unsigned int pos);
+
+    /**
+     * @brief      Select which texels of the sprites are drawn; opaque texels
+     *             write depth such that the draw order of the tiles does not
+     *             matter, whereas the partially transparent edges are blended
+     *             over them without occluding anything
+     *
+     * @param[in]  edges  Whether to draw the edges instead of the opaque texels
+     */
+    void set_alpha_pass(bool edges);
+
+    /**
+     * @brief      Set the range of screen rows (2y + x) that is mapped onto the
+     *             depth range; requires the sprite shader to be bound
+     *
+     * @param[in]  rowmin  The row in front
+     * @param[in]  rowmax  The row in the back
+     */
+    void set_depth_range(int rowmin, int rowmax);
+
+    /**
+     * @brief      Build the instance data of a single tile
+     *
+     * @param[in]  tile_id  The tile identifier
+     * @param[in]  x        x coordinate
+     * @param[in]  y        y coordinate
+     * @param[in]  color    The tile color
+     *
+     * @return     The tile instance.
+     */
+    TileInstance build_instance(unsigned int tile_id, int x, int y, const QVector3D& color) const;
+
+    /**
+     * @brief      Build the instance data of the tile on the map at a coordinate
+     *
+     * @param[in]  x     x coordinate
+     * @param[in]  y     y coordinate
+     *
+     * @return     The tile instance.
+     */
+    TileInstance build_map_instance(int x, int y) const;
+
+    /**
+     * @brief      Update the instance buffer after a modification of the map
+     *
+     * @param[in]  event  The event
+     * @param[in]  x      x coordinate
+     * @param[in]  y      y coordinate
+     */
+    void update_instance(MapEvent event, int x, int y);
+
+    /**
+     * @brief      Rebuild the complete instance buffer from the map
+     */
+    void rebuild_instances();
+
+    /**
+     * @brief      Transfer all modified instances to the GPU
+     */
+    void upload_instances();
 };
@@ -41,21 +41,12 @@ void Scene::calculate_ray(const QPoint& mouse_position, QVector3D* ray_origin, Q
     const float screen_width = (float)this->canvas_width;
     const float screen_height = (float)this->canvas_height;
 
-    const QVector3D ray_nds = QVector3D((2.0f * (float)mouse_position.x()) / screen_width - 1.0f,
-                                         1.0f - (2.0f * (float)mouse_position.y()) / screen_height,
-                                         1.0);
+    const float ndc_x = (2.0f * (float)mouse_position.x()) / screen_width - 1.0f;
+    const float ndc_y = 1.0f - (2.0f * (float)mouse_position.y()) / screen_height;
 
-    const QVector4D ray_clip(ray_nds[0], ray_nds[1], 0.0, 1.0);
-
-    // the position on the 'camera screen' determines the origin of the
-    // ray vector in orthographic projection
-    QVector4D ray_eye = this->projection.inverted() * ray_clip;
-    ray_eye = QVector4D(ray_eye[0], ray_eye[1], 0.0, 0.0);
-    *ray_origin = (this->camera_position + this->view.inverted() * ray_eye).toVector3D();
-
-    // if the projection is orthographic, the ray vector is the same
-    // as the view direction of the camera (in world space)
-    *ray_direction = -this->camera_position.normalized();
+    // the ray runs from the near to the far plane
+    *ray_origin = this->inverse_viewprojection.map(QVector3D(ndc_x, ndc_y, -1.0f));
+    *ray_direction = (this->inverse_viewprojection.map(QVector3D(ndc_x, ndc_y, 1.0f)) - *ray_origin).normalized();
 }
 
 /**
@@ -121,10 +112,7 @@ QVector3D Scene::cartesian_to_hexcube(const QVector3D& cartcoord) const {
  * @brief      Set mouse position in world space to determine which tile to highlight
  */
 void Scene::set_mouse_pos(const QVector3D& worldpos) {
-    auto new_tile_highlight = this->cartesian_to_hexcube(worldpos);
-    new_tile_highlight[0] = std::round(new_tile_highlight[0]);
-    new_tile_highlight[1] = std::round(new_tile_highlight[1]);
-    new_tile_highlight[2] = std::round(new_tile_highlight[2]);
+    const QVector3D new_tile_highlight = round_hexcube(this->cartesian_to_hexcube(worldpos));
 
     if(new_tile_highlight != this->tile_highlight) {
         this->tile_highlight = new_tile_highlight;
@@ -140,16 +128,35 @@ void Scene::set_mouse_pos(const QVector3D& worldpos) {
  * @return     The hexpos at mouse position.
  */
 QVector3D Scene::get_hexpos_at_mousepos(const QPoint& mouse_position) const {
-    QVector3D ray_origin, ray_direction;
-    this->calculate_ray(mouse_position, &ray_origin, &ray_direction);
-    auto worldpos = this->calculate_ray_plane_intersection(ray_origin, ray_direction, QVector3D(0.0f, 0.0f, 0.0f), QVector3D(0.0f, 0.0f, 1.0f));
-    worldpos += this->camera_look_at;
-    auto hexpos = this->cartesian_to_hexcube(worldpos);
-    hexpos[0] = std::round(hexpos[0]);
-    hexpos[1] = std::round(hexpos[1]);
-    hexpos[2] = std::round(hexpos[2]);
-
-    return hexpos;
+    return round_hexcube(this->cartesian_to_hexcube(this->get_worldpos_at_mousepos(mouse_position)));
+}
+
+/**
+ * @brief      Round fractional hexcube coordinates to the hexcube holding
+ *             them, such that the coordinates always sum to zero
+ *
+ * @param[in]  hexcoord  The fractional hexcube coordinates
+ *
+ * @return     The hexcube coordinates
+ */
+QVector3D Scene::round_hexcube(const QVector3D& hexcoord) {
+    float x = std::round(hexcoord[0]);
+    float y = std::round(hexcoord[1]);
+    float z = std::round(hexcoord[2]);
+
+    // the component that was rounded the most follows from the other two
+    const float dx = std::fabs(x - hexcoord[0]);
+    const float dy = std::fabs(y - hexcoord[1]);
+    const float dz = std::fabs(z - hexcoord[2]);
+    if(dx > dy && dx > dz) {
+        x = -y - z;
+    } else if(dy > dz) {
+        y = -x - z;
+    } else {
+        z = -x - y;
+    }
+
+    return QVector3D(x, y, z);
 }
 
 /**
@@ -158,6 +165,24 @@ QVector3D Scene::get_hexpos_at_mousepos(const QPoint& mouse_position) const {
 void Scene::update_view() {
     this->view.setToIdentity();
     this->view.lookAt(this->camera_position, this->camera_look_at, QVector3D(0.0, -1.0, 0.0));
+    this->update_inverse();
+}
+
+/**
+ * @brief      Set the projection matrix
+ *
+ * @param[in]  _projection  The projection
+ */
+void Scene::set_projection(const QMatrix4x4& _projection) {
+    this->projection = _projection;
+    this->update_inverse();
+}
+
+/**
+ * @brief      Update the inverse of the view projection matrix
+ */
+void Scene::update_inverse() {
+    this->inverse_viewprojection = (this->projection * this->view).inverted();
 }
 
 /**
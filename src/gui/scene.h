@@ -48,6 +48,9 @@ public:
     QMatrix4x4 hex2cart;
     QMatrix4x4 cart2hex;
 
+    // inverse of projection * view, updated with the camera
+    QMatrix4x4 inverse_viewprojection;
+
     QVector3D tile_highlight; // which tile to highlight
 
     bool flag_dragging = false;
@@ -135,6 +138,40 @@ public:
      */
     void update_view();
 
+    /**
+     * @brief      Set the projection matrix
+     *
+     * @param[in]  _projection  The projection
+     */
+    void set_projection(const QMatrix4x4& _projection);
+
+    /**
+     * @brief      Gets the position on the ground plane below the mouse
+     *
+     * @param[in]  mouse_position  The mouse position
+     *
+     * @return     The position in world space
+     */
+    inline QVector3D get_worldpos_at_mousepos(const QPoint& mouse_position) const {
+        // the camera looks straight down with an orthographic projection,
+        // hence every depth maps onto the same position on the ground plane
+        const float ndc_x = (2.0f * (float)mouse_position.x()) / (float)this->canvas_width - 1.0f;
+        const float ndc_y = 1.0f - (2.0f * (float)mouse_position.y()) / (float)this->canvas_height;
+        QVector3D worldpos = this->inverse_viewprojection.map(QVector3D(ndc_x, ndc_y, 0.0f));
+        worldpos.setZ(0.0f);
+        return worldpos;
+    }
+
+    /**
+     * @brief      Round fractional hexcube coordinates to the hexcube holding
+     *             them, such that the coordinates always sum to zero
+     *
+     * @param[in]  hexcoord  The fractional hexcube coordinates
+     *
+     * @return     The hexcube coordinates
+     */
+    static QVector3D round_hexcube(const QVector3D& hexcoord);
+
     /**
      * @brief      Sets the dragging.
      *
@@ -150,6 +187,11 @@ private:
      */
     void build_transformation_matrices();
 
+    /**
+     * @brief      Update the inverse of the view projection matrix
+     */
+    void update_inverse();
+
 signals:
     /**
      * @brief      Signal to update the screen
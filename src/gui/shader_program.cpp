@@ -64,6 +64,18 @@ void ShaderProgram::add_attributes() {
             this->m_program->bindAttributeLocation("position", 0);
             this->m_program->bindAttributeLocation("uv", 1);
         break;
+        case ShaderProgramType::InstancedSpriteShader:
+            this->m_program->bindAttributeLocation("position", 0);
+            this->m_program->bindAttributeLocation("hexpos", 2);
+            this->m_program->bindAttributeLocation("uvrect", 3);
+            this->m_program->bindAttributeLocation("tilecolor", 4);
+        break;
+        case ShaderProgramType::BackgroundShader:
+            this->m_program->bindAttributeLocation("position", 0);
+        break;
+        case ShaderProgramType::ImpostorShader:
+            this->m_program->bindAttributeLocation("position", 0);
+        break;
         default:
             // nothing to do
         break;
@@ -102,6 +114,49 @@ void ShaderProgram::add_uniforms() {
         return;
     }
 
+    if (this->type == ShaderProgramType::InstancedSpriteShader) {
+        this->uniforms.emplace("viewprojection", this->m_program->uniformLocation("viewprojection"));
+        this->uniforms.emplace("hex2cart", this->m_program->uniformLocation("hex2cart"));
+        this->uniforms.emplace("tile_offset", this->m_program->uniformLocation("tile_offset"));
+        this->uniforms.emplace("tile_scale", this->m_program->uniformLocation("tile_scale"));
+        this->uniforms.emplace("highlight", this->m_program->uniformLocation("highlight"));
+        this->uniforms.emplace("highlight_factor", this->m_program->uniformLocation("highlight_factor"));
+        this->uniforms.emplace("depth_range", this->m_program->uniformLocation("depth_range"));
+        this->uniforms.emplace("alpha_range", this->m_program->uniformLocation("alpha_range"));
+        this->uniforms.emplace("selection", this->m_program->uniformLocation("selection"));
+        this->uniforms.emplace("selection_color", this->m_program->uniformLocation("selection_color"));
+        this->uniforms.emplace("tex", this->m_program->uniformLocation("tex"));
+        return;
+    }
+
+    if (this->type == ShaderProgramType::BackgroundShader) {
+        this->uniforms.emplace("viewprojection", this->m_program->uniformLocation("viewprojection"));
+        this->uniforms.emplace("hex2cart", this->m_program->uniformLocation("hex2cart"));
+        this->uniforms.emplace("tile_offset", this->m_program->uniformLocation("tile_offset"));
+        this->uniforms.emplace("tile_scale", this->m_program->uniformLocation("tile_scale"));
+        this->uniforms.emplace("uvrect", this->m_program->uniformLocation("uvrect"));
+        this->uniforms.emplace("hex_xmin", this->m_program->uniformLocation("hex_xmin"));
+        this->uniforms.emplace("hex_rowmin", this->m_program->uniformLocation("hex_rowmin"));
+        this->uniforms.emplace("hex_rows", this->m_program->uniformLocation("hex_rows"));
+        this->uniforms.emplace("color", this->m_program->uniformLocation("color"));
+        this->uniforms.emplace("tex", this->m_program->uniformLocation("tex"));
+        return;
+    }
+
+    if (this->type == ShaderProgramType::ImpostorShader) {
+        this->uniforms.emplace("viewprojection", this->m_program->uniformLocation("viewprojection"));
+        this->uniforms.emplace("impostor_viewprojection", this->m_program->uniformLocation("impostor_viewprojection"));
+        this->uniforms.emplace("rect", this->m_program->uniformLocation("rect"));
+        this->uniforms.emplace("rows", this->m_program->uniformLocation("rows"));
+        this->uniforms.emplace("depth_range", this->m_program->uniformLocation("depth_range"));
+        this->uniforms.emplace("alpha_range", this->m_program->uniformLocation("alpha_range"));
+        this->uniforms.emplace("depthtex", this->m_program->uniformLocation("depthtex"));
+        this->uniforms.emplace("selection_rect", this->m_program->uniformLocation("selection_rect"));
+        this->uniforms.emplace("selection_color", this->m_program->uniformLocation("selection_color"));
+        this->uniforms.emplace("tex", this->m_program->uniformLocation("tex"));
+        return;
+    }
+
     if (this->type == ShaderProgramType::CanvasShader) {
         this->uniforms.emplace("tex", this->m_program->uniformLocation("tex"));
         return;
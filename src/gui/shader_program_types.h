@@ -29,6 +29,9 @@ enum class ShaderProgramType {
     StereoscopicShader,
     LineShader,
     SpriteShader,
+    InstancedSpriteShader,
+    BackgroundShader,
+    ImpostorShader,
     CanvasShader
 };
 
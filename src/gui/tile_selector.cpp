@@ -24,10 +24,12 @@
 /**
  * @brief      Constructs a new instance.
  *
- * @param      parent  The parent
+ * @param[in]  _tile_manager  The tile manager
+ * @param      parent         The parent
  */
-TileSelector::TileSelector(QWidget *parent) :
-    QWidget(parent) {
+TileSelector::TileSelector(const std::shared_ptr<TileManager>& _tile_manager, QWidget *parent) :
+    QWidget(parent),
+    tile_manager(_tile_manager) {
 
     this->setMaximumWidth(350);
 
@@ -70,33 +72,10 @@ TileSelector::TileSelector(QWidget *parent) :
  * @brief      Populate list of tiles
  */
 void TileSelector::populate_tile_list() {
-    QString filename = "tiledata.json";
-    QTemporaryDir tmp_dir;
-    QString path = tmp_dir.path() + "/" + filename;
-    QFile::copy(":/assets/fragments/" + filename, path);
-
-    std::unordered_map<std::string, unsigned int> tiles;
+    // one button per base tile of the catalogue
     std::vector<std::string> tilenames;
-
-    try {
-        boost::property_tree::ptree root;
-        QTemporaryDir tmp_dir;
-        QFile::copy(":/assets/configuration/tiledata.json", tmp_dir.path() + "/tiledata.json");
-        boost::property_tree::read_json(tmp_dir.path().toStdString() + "/tiledata.json", root);
-
-        for(auto iter = root.begin(); iter != root.end(); iter++) {
-            std::string name = iter->first.substr(0,4);
-            auto got = tiles.find(name);
-            if(got != tiles.end()) {
-                got->second++;
-            } else {
-                tiles.emplace(name, 1);
-                tilenames.push_back(name);
-            }
-        }
-
-    } catch(std::exception const& ex) {
-        throw std::runtime_error("Could not open or parse file: " + path.toStdString());
+    for(unsigned int i=0; i<this->tile_manager->get_nr_bases(); i++) {
+        tilenames.push_back(this->tile_manager->get_base_code(i));
     }
 
     std::sort(tilenames.begin(), tilenames.end());
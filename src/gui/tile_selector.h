@@ -26,20 +26,17 @@
 #include <QVBoxLayout>
 #include <QLineEdit>
 #include <QListWidget>
-#include <QTemporaryDir>
 #include <QPushButton>
 #include <QScrollArea>
 #include <QDebug>
 #include <QVector3D>
 #include <QGridLayout>
 
-// boost headers
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/foreach.hpp>
-#include <boost/lexical_cast.hpp>
-
 #include <unordered_map>
+#include <memory>
+#include <algorithm>
+
+#include "../data/tile_manager.h"
 
 class TileSelector : public QWidget {
     Q_OBJECT
@@ -49,6 +46,8 @@ private:
     QGridLayout *layout;
     QLabel *label_selection_image;
 
+    std::shared_ptr<TileManager> tile_manager;
+
     std::unordered_map<std::string, std::string> long_names;
     std::vector<QPushButton*> buttons;
 
@@ -56,9 +55,10 @@ public:
     /**
      * @brief      Constructs a new instance.
      *
-     * @param      parent  The parent
+     * @param[in]  _tile_manager  The tile manager
+     * @param      parent         The parent
      */
-    TileSelector(QWidget *parent = nullptr);
+    TileSelector(const std::shared_ptr<TileManager>& _tile_manager, QWidget *parent = nullptr);
 
 private:
     /**
@@ -26,56 +26,271 @@ UserAction::UserAction(const std::shared_ptr<Scene> _scene,
 		       		   const std::shared_ptr<TileManager>& _tile_manager) :
 	scene(_scene),
 	map(_map),
-	tile_manager(_tile_manager) {
+	tile_manager(_tile_manager),
+	journal(std::make_shared<MapJournal>()) {
 
 }
 
 /**
- * @brief      Adds a tile.
+ * @brief      Adds the active tile on the empty cells under the brush
  */
 void UserAction::add_tile() {
-	auto pos = this->scene->get_hexpos_highlight();
-	if(QVector3D::dotProduct(QVector3D(1.0, 1.0, 1.0), pos) == 0 && this->active_tile_id >= 0) {
-		this->map->add_tile(this->active_tile_id, pos[0], pos[1], pos[2]);
+	if(this->active_tile_id < 0) {
+		return;
 	}
+
+	const int tile_id = this->active_tile_id;
+	this->modify(this->get_brush_cells(), [tile_id](int current) {
+		return current < 0 ? tile_id : current;
+	});
 }
 
 /**
- * @brief      Remove a tile
+ * @brief      Remove the tiles under the brush
  */
 void UserAction::remove_tile() {
-    auto pos = this->scene->get_hexpos_highlight();
-    this->map->remove_tile(pos[0], pos[1]);
+	this->modify(this->get_brush_cells(), [](int) {
+		return -1;
+	});
 }
 
 /**
- * @brief   Substitute a tile
+ * @brief   Rotate the tiles under the brush
  */
 void UserAction::rotate_tile() {
+	const auto& tile_manager = this->tile_manager;
+	this->modify(this->get_brush_cells(), [&tile_manager](int current) {
+		return current < 0 ? current : (int)tile_manager->rotate(current, 1);
+	});
+}
+
+/**
+ * @brief   Substitute the tiles under the brush by the active tile
+ */
+void UserAction::substitute_tile() {
+	if(this->active_tile_id < 0) {
+		return;
+	}
+
+	const int tile_id = this->active_tile_id;
+	this->modify(this->get_brush_cells(), [tile_id](int current) {
+		return current < 0 ? current : tile_id;
+	});
+}
+
+/**
+ * @brief      Substitute the tiles connected to the highlighted tile that
+ *             share its type, regardless of rotation, by the active tile;
+ *             regions of more than max_fill_cells tiles are refused
+ */
+void UserAction::flood_fill() {
+	auto pos = this->scene->get_hexpos_highlight();
+	if(QVector3D::dotProduct(QVector3D(1.0, 1.0, 1.0), pos) != 0 || this->active_tile_id < 0) {
+		return;
+	}
+
+	const int start_id = this->map->get_tile_id(pos[0], pos[1]);
+	if(start_id < 0) {
+		return;
+	}
+
+	const unsigned int base = this->tile_manager->base_of(start_id);
+	const auto& tile_manager = this->tile_manager;
+	bool truncated = false;
+	const auto cells = MapRegion::flood_fill(*this->map, pos[0], pos[1], [base, &tile_manager](int tile_id) {
+		return tile_id >= 0 && tile_manager->base_of(tile_id) == base;
+	}, max_fill_cells, &truncated);
+
+	// filling only part of the region would leave an arbitrary cut
+	if(truncated) {
+		emit(fill_too_large((int)max_fill_cells));
+		return;
+	}
+
+	const int tile_id = this->active_tile_id;
+	this->modify(cells, [tile_id](int) {
+		return tile_id;
+	});
+}
+
+/**
+ * @brief      Place the active tile on, or remove the tiles from, all
+ *             cells within a screen aligned rectangle
+ *
+ * @param[in]  from   Hexcube coordinates of the first corner
+ * @param[in]  to     Hexcube coordinates of the second corner
+ * @param[in]  erase  Whether to remove the tiles
+ */
+void UserAction::fill_rectangle(const QVector3D& from, const QVector3D& to, bool erase) {
+	if(!erase && this->active_tile_id < 0) {
+		return;
+	}
+
+	const int tile_id = erase ? -1 : this->active_tile_id;
+	const auto cells = MapRegion::rectangle(from[0], from[1], to[0], to[1]);
+	this->modify(cells, [tile_id](int) {
+		return tile_id;
+	});
+}
+
+/**
+ * @brief      Select the cells within a screen aligned rectangle for
+ *             copying; the first corner becomes the anchor
+ *
+ * @param[in]  from  Hexcube coordinates of the first corner
+ * @param[in]  to    Hexcube coordinates of the second corner
+ */
+void UserAction::select_rectangle(const QVector3D& from, const QVector3D& to) {
+	this->selection = MapRegion::rectangle(from[0], from[1], to[0], to[1]);
+	this->selection_anchor = AxialCoordinate(from[0], from[1]);
+}
+
+/**
+ * @brief      Copy the tiles of the selection to the clipboard
+ *
+ * @return     The number of copied tiles
+ */
+size_t UserAction::copy_selection() {
+	this->clipboard = MapFragment::copy(*this->map, this->selection, this->selection_anchor.first, this->selection_anchor.second);
+	return this->clipboard->size();
+}
+
+/**
+ * @brief      Place the clipboard with its anchor on the highlighted cell
+ *
+ * @return     True if tiles were placed, False otherwise.
+ */
+bool UserAction::paste() {
 	auto pos = this->scene->get_hexpos_highlight();
-	if(QVector3D::dotProduct(QVector3D(1.0, 1.0, 1.0), pos) == 0) {
-		int tile_id = this->map->get_tile_id(pos[0], pos[1]);
-		if(tile_id >= 0) {
-			auto name = this->tile_manager->get_tilename(tile_id);
-			int angle = boost::lexical_cast<int>(name.substr(name.size()-3, 3));
-			angle = (angle + 60) % 360;
-			int new_tile_id = this->tile_manager->get_tile_id(name.substr(0,5) + (boost::format("%03i") % angle).str());
-			this->map->substitute_tile(new_tile_id, pos[0], pos[1]);
+	if(QVector3D::dotProduct(QVector3D(1.0, 1.0, 1.0), pos) != 0 || !this->clipboard || this->clipboard->empty()) {
+		return false;
+	}
+
+	if(this->inventory) {
+		std::vector<std::pair<int, int>> changes;
+		changes.reserve(this->clipboard->size());
+		for(const FragmentTile& tile : this->clipboard->get_tiles()) {
+			changes.emplace_back(this->map->get_tile_id(pos[0] + tile.dx, pos[1] + tile.dy), tile.tile_id);
+		}
+		if(!this->fits_inventory(changes)) {
+			return false;
 		}
 	}
+
+	this->clipboard->paste(*this->map, *this->journal, pos[0], pos[1]);
+	return true;
 }
 
 /**
- * @brief   Substitute a tile
+ * @brief      Rotate the clipboard around its anchor; both the positions
+ *             and the tiles turn counterclockwise on the screen
+ *
+ * @param[in]  steps  Number of counterclockwise steps of 60 degrees
  */
-void UserAction::substitute_tile() {
+void UserAction::rotate_clipboard(int steps) {
+	if(this->clipboard) {
+		this->clipboard = this->clipboard->rotate(*this->tile_manager, steps);
+	}
+}
+
+/**
+ * @brief      Revert the most recent modification, provided that the
+ *             inventory holds the tiles that are placed back
+ *
+ * @return     True if a modification was reverted, False otherwise.
+ */
+bool UserAction::undo() {
+	if(this->inventory) {
+		std::vector<std::pair<int, int>> changes;
+		this->journal->for_each_undo_change([&changes](int from, int to) {
+			changes.emplace_back(from, to);
+		});
+		if(!this->fits_inventory(changes)) {
+			return false;
+		}
+	}
+
+	return this->journal->undo(*this->map);
+}
+
+/**
+ * @brief      Reapply the most recently reverted modification, provided
+ *             that the inventory holds the tiles that are placed
+ *
+ * @return     True if a modification was reapplied, False otherwise.
+ */
+bool UserAction::redo() {
+	if(this->inventory) {
+		std::vector<std::pair<int, int>> changes;
+		this->journal->for_each_redo_change([&changes](int from, int to) {
+			changes.emplace_back(from, to);
+		});
+		if(!this->fits_inventory(changes)) {
+			return false;
+		}
+	}
+
+	return this->journal->redo(*this->map);
+}
+
+/**
+ * @brief      Get the cells under the brush
+ *
+ * @return     The cells, empty if no cell is highlighted
+ */
+std::vector<AxialCoordinate> UserAction::get_brush_cells() const {
 	auto pos = this->scene->get_hexpos_highlight();
-	if(QVector3D::dotProduct(QVector3D(1.0, 1.0, 1.0), pos) == 0) {
-		int tile_id = this->map->get_tile_id(pos[0], pos[1]);
-		if(tile_id >= 0) {
-			this->map->substitute_tile(this->active_tile_id, pos[0], pos[1]);
+	if(QVector3D::dotProduct(QVector3D(1.0, 1.0, 1.0), pos) != 0) {
+		return std::vector<AxialCoordinate>();
+	}
+
+	return MapRegion::hexagon(pos[0], pos[1], this->brush_radius);
+}
+
+/**
+ * @brief      Check whether the inventory holds the tiles placed by a
+ *             set of changes; the first shortage is signalled
+ *
+ * @param[in]  changes  The tile ids (-1 if empty) before and after every change
+ *
+ * @return     True if the changes can be made, False otherwise.
+ */
+bool UserAction::fits_inventory(const std::vector<std::pair<int, int>>& changes) {
+	// net number of tiles taken from the inventory per affected base tile,
+	// such that the cost follows the size of the change and not the catalogue
+	std::unordered_map<unsigned int, int64_t> delta;
+	for(const auto& change : changes) {
+		if(change.first == change.second) {
+			continue;
+		}
+		if(change.first >= 0) {
+			delta[this->tile_manager->base_of(change.first)]--;
+		}
+		if(change.second >= 0) {
+			delta[this->tile_manager->base_of(change.second)]++;
 		}
 	}
+
+	// report the shortage of the lowest base id, independent of hashing
+	std::vector<std::pair<unsigned int, int64_t>> placed;
+	for(const auto& item : delta) {
+		if(item.second > 0) {
+			placed.push_back(item);
+		}
+	}
+	std::sort(placed.begin(), placed.end());
+
+	for(const auto& item : placed) {
+		const unsigned int base_id = item.first;
+		if(!this->inventory->can_place(*this->map, base_id, item.second)) {
+			const int64_t available = (int64_t)this->inventory->get_owned(base_id) - (int64_t)this->inventory->get_used(*this->map, base_id);
+			emit(inventory_exceeded(QString::fromStdString(this->tile_manager->get_base_code(base_id)),
+			                        (int)(item.second - std::max<int64_t>(available, 0))));
+			return false;
+		}
+	}
+
+	return true;
 }
 
 /**
@@ -84,5 +299,5 @@ void UserAction::substitute_tile() {
  * @param[in]  label  The label
  */
 void UserAction::slot_new_tile(const QString& label) {
-	this->active_tile_id = this->tile_manager->get_tile_id(label.toStdString() + "_000");
+	this->active_tile_id = this->tile_manager->get_tile_id(label.toStdString(), 0);
 }
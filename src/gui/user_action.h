@@ -24,11 +24,16 @@
 #include <QObject>
 #include <QString>
 
-#include <boost/lexical_cast.hpp>
-
 #include <memory>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 #include "scene.h"
 #include "../data/map.h"
+#include "../data/map_journal.h"
+#include "../data/map_region.h"
+#include "../data/map_fragment.h"
+#include "../data/inventory.h"
 #include "../data/tile_manager.h"
 
 class UserAction : public QObject {
@@ -38,8 +43,19 @@ private:
 	std::shared_ptr<Scene> scene;
 	std::shared_ptr<Map> map;
 	std::shared_ptr<TileManager> tile_manager;
+	std::shared_ptr<MapJournal> journal;    // modifications made to the map, for undo and redo
 
 	int active_tile_id = -1;
+	unsigned int brush_radius = 0;          // cells around the highlighted cell that are modified
+
+	std::vector<AxialCoordinate> selection; // cells that are copied
+	AxialCoordinate selection_anchor;       // cell of the selection that is placed at the cursor on paste
+	std::shared_ptr<const MapFragment> clipboard;
+
+	std::shared_ptr<const Inventory> inventory;    // tiles that may be placed, nullptr if unconstrained
+
+	static constexpr unsigned int max_brush_radius = 32;
+	static constexpr size_t max_fill_cells = 1 << 20;  // maximum number of tiles affected by a flood fill
 
 public:
 	UserAction(const std::shared_ptr<Scene> _scene,
@@ -53,29 +69,190 @@ public:
      */
     inline void set_map(const std::shared_ptr<Map> _map) {
         this->map = _map;
+        this->journal->clear();
+    }
+
+    /**
+     * @brief      Set the radius of the brush
+     *
+     * @param[in]  _brush_radius  The brush radius, 0 affects a single cell
+     */
+    inline void set_brush_radius(unsigned int _brush_radius) {
+        this->brush_radius = std::min(_brush_radius, max_brush_radius);
+    }
+
+    inline unsigned int get_brush_radius() const {
+        return this->brush_radius;
     }
 
 	/**
-     * @brief      Adds a tile.
+     * @brief      Adds the active tile on the empty cells under the brush
      */
     void add_tile();
 
     /**
-     * @brief      Remove a tile
+     * @brief      Remove the tiles under the brush
      */
     void remove_tile();
 
 	/**
-     * @brief   Rotate a tile
+     * @brief   Rotate the tiles under the brush
      */
     void rotate_tile();
 
 	/**
-     * @brief   Substitute a tile
+     * @brief   Substitute the tiles under the brush by the active tile
      */
     void substitute_tile();
 
+    /**
+     * @brief      Substitute the tiles connected to the highlighted tile that
+     *             share its type, regardless of rotation, by the active tile;
+     *             regions of more than max_fill_cells tiles are refused
+     */
+    void flood_fill();
+
+    /**
+     * @brief      Place the active tile on, or remove the tiles from, all
+     *             cells within a screen aligned rectangle
+     *
+     * @param[in]  from   Hexcube coordinates of the first corner
+     * @param[in]  to     Hexcube coordinates of the second corner
+     * @param[in]  erase  Whether to remove the tiles
+     */
+    void fill_rectangle(const QVector3D& from, const QVector3D& to, bool erase);
+
+    /**
+     * @brief      Select the cells within a screen aligned rectangle for
+     *             copying; the first corner becomes the anchor
+     *
+     * @param[in]  from  Hexcube coordinates of the first corner
+     * @param[in]  to    Hexcube coordinates of the second corner
+     */
+    void select_rectangle(const QVector3D& from, const QVector3D& to);
+
+    /**
+     * @brief      Copy the tiles of the selection to the clipboard
+     *
+     * @return     The number of copied tiles
+     */
+    size_t copy_selection();
+
+    /**
+     * @brief      Place the clipboard with its anchor on the highlighted cell
+     *
+     * @return     True if tiles were placed, False otherwise.
+     */
+    bool paste();
+
+    /**
+     * @brief      Rotate the clipboard around its anchor; both the positions
+     *             and the tiles turn counterclockwise on the screen
+     *
+     * @param[in]  steps  Number of counterclockwise steps of 60 degrees
+     */
+    void rotate_clipboard(int steps);
+
+    /**
+     * @brief      Replace the clipboard; the fragment is shared, not copied
+     *
+     * @param[in]  fragment  The fragment
+     */
+    inline void set_clipboard(const std::shared_ptr<const MapFragment>& fragment) {
+        this->clipboard = fragment;
+    }
+
+    inline const std::shared_ptr<const MapFragment>& get_clipboard() const {
+        return this->clipboard;
+    }
+
+    inline const std::vector<AxialCoordinate>& get_selection() const {
+        return this->selection;
+    }
+
+    /**
+     * @brief      Restrict modifications to the tiles of an inventory
+     *
+     * @param[in]  _inventory  The inventory, nullptr to lift the restriction
+     */
+    inline void set_inventory(const std::shared_ptr<const Inventory>& _inventory) {
+        this->inventory = _inventory;
+    }
+
+    inline const std::shared_ptr<const Inventory>& get_inventory() const {
+        return this->inventory;
+    }
+
+    /**
+     * @brief      Revert the most recent modification, provided that the
+     *             inventory holds the tiles that are placed back
+     *
+     * @return     True if a modification was reverted, False otherwise.
+     */
+    bool undo();
+
+    /**
+     * @brief      Reapply the most recently reverted modification, provided
+     *             that the inventory holds the tiles that are placed
+     *
+     * @return     True if a modification was reapplied, False otherwise.
+     */
+    bool redo();
+
 private:
+    /**
+     * @brief      Get the cells under the brush
+     *
+     * @return     The cells, empty if no cell is highlighted
+     */
+    std::vector<AxialCoordinate> get_brush_cells() const;
+
+	/**
+     * @brief      Modify a set of cells as a single transaction, provided
+     *             that the inventory holds the tiles that are placed
+     *
+     * @param[in]  cells      The cells
+     * @param[in]  transform  Function accepting the current tile id of a
+     *                        cell (-1 if empty) and returning its new tile
+     *                        id (-1 to remove the tile)
+     *
+     * @return     True if the modification was made, False otherwise.
+     */
+	template <typename Function>
+	bool modify(const std::vector<AxialCoordinate>& cells, Function transform) {
+		if(!this->inventory) {
+			this->journal->set_tiles(*this->map, cells, transform);
+			return true;
+		}
+
+		// the new tile ids are determined once, for the check and the modification
+		std::vector<std::pair<int, int>> changes;
+		changes.reserve(cells.size());
+		for(const auto& cell : cells) {
+			const int current = this->map->get_tile_id(cell.first, cell.second);
+			changes.emplace_back(current, transform(current));
+		}
+		if(!this->fits_inventory(changes)) {
+			return false;
+		}
+
+		// set_tiles visits the cells once and in order
+		size_t i = 0;
+		this->journal->set_tiles(*this->map, cells, [&changes, &i](int) {
+			return changes[i++].second;
+		});
+		return true;
+	}
+
+	/**
+     * @brief      Check whether the inventory holds the tiles placed by a
+     *             set of changes; the first shortage is signalled
+     *
+     * @param[in]  changes  The tile ids (-1 if empty) before and after every change
+     *
+     * @return     True if the changes can be made, False otherwise.
+     */
+	bool fits_inventory(const std::vector<std::pair<int, int>>& changes);
 
 public slots:
     /**
@@ -84,4 +261,22 @@ public slots:
      * @param[in]  label  The label
      */
 	void slot_new_tile(const QString& label);
+
+signals:
+    /**
+     * @brief      Signal that a modification was refused as the inventory
+     *             lacks tiles
+     *
+     * @param[in]  tilecode  Code of the base tile that is short
+     * @param[in]  shortage  Number of tiles that are lacking
+     */
+    void inventory_exceeded(const QString& tilecode, int shortage);
+
+    /**
+     * @brief      Signal that a flood fill was refused as the region is too
+     *             large
+     *
+     * @param[in]  max_cells  Maximum number of tiles of a flood fill
+     */
+    void fill_too_large(int max_cells);
 };
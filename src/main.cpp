@@ -20,6 +20,7 @@
  **************************************************************************/
 
 #include <QApplication>
+#include <QGuiApplication>
 #include <QDesktopWidget>
 #include <QSurfaceFormat>
 #include <QStatusBar>
@@ -30,10 +31,29 @@
 #include <ctime>
 
 #include "gui/mainwindow.h"
+#include "cli/batch_processor.h"
 #include "config.h"
 
 int main(int argc, char *argv[]) {
+    // maps can be processed from the command line without a display; maps
+    // are rendered on the offscreen platform unless another one is requested
+    if(BatchProcessor::is_batch_command(argc, argv)) {
+        std::unique_ptr<QCoreApplication> app;
+        if(BatchProcessor::requires_rendering(argc, argv)) {
+            if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+                qputenv("QT_QPA_PLATFORM", "offscreen");
+            }
+            app = std::make_unique<QGuiApplication>(argc, argv);
+        } else {
+            app = std::make_unique<QCoreApplication>(argc, argv);
+        }
+        QCoreApplication::setApplicationName(PROGRAM_NAME);
+        QCoreApplication::setApplicationVersion(PROGRAM_VERSION);
+        return BatchProcessor().run(app->arguments());
+    }
+
     QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(PROGRAM_NAME);    // locates the application data, e.g. the stamps
 
     // write boot of program
     std::ofstream lf("execution.log");
@@ -46,7 +66,7 @@ int main(int argc, char *argv[]) {
     // set OpenGL surface settings
     QSurfaceFormat fmt;
     fmt.setDepthBufferSize(24);
-    fmt.setSamples(4);
+    fmt.setSamples(4);  // used by the multisampling render quality
     fmt.setVersion(3, 3);
     fmt.setProfile(QSurfaceFormat::CoreProfile);
     fmt.setSwapBehavior(QSurfaceFormat::DoubleBuffer);